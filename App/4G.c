@@ -1,13 +1,60 @@
 #include "4G.h"
 #include "water.h"
 #include "timer.h"
+#include "calib.h"
+#include "json.h"
+#include "framer.h"
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 
-// 定义接收缓冲区
+// 接收环形缓冲区，循环DMA直接写入
 static uint8_t g4_rx_buffer[UART_RX_BUFFER_SIZE];
-static uint16_t g4_rx_len = 0;
-static UART_ReceiveState g4_rx_state = UART_IDLE;
+static RING_TypeDef g4_rx_ring;
+
+// 接收数据分帧：响应行、透传JSON
+static FRAMER_TypeDef g4_framer;
+static uint32_t g4_rx_clear_to = 0;     // 发送命令时的写入位置，之前收到的数据作废
+static uint8_t g4_rx_clear = 0;
+
+// AT命令脚本执行状态
+static const G4_ATStep_TypeDef *g4_at_steps;
+static uint8_t g4_at_count = 0;
+static uint8_t g4_at_index = 0;
+static uint8_t g4_at_tries = 0;                 // 当前步骤已重发次数
+static G4_ATPhase_TypeDef g4_at_phase = G4_AT_IDLE;
+static uint32_t g4_at_tick = 0;                 // 当前阶段开始时刻(ms)
+static void (*g4_at_done)(HAL_StatusTypeDef status) = NULL;
+static uint32_t g4_retry_tick = 0;              // 上次MQTT连接失败时刻(ms)
+
+// 发送队列：主循环写入g4_tx_in，DMA发送完成中断推进g4_tx_out
+static G4_TxDesc_TypeDef g4_tx_queue[G4_TX_QUEUE];
+static volatile uint8_t g4_tx_in = 0;
+static volatile uint8_t g4_tx_out = 0;
+static volatile uint8_t g4_tx_busy = 0;         // DMA正在发送队首
+static uint32_t g4_tx_queued_bytes = 0;         // 累计入队字节数(主循环)
+static volatile uint32_t g4_tx_sent_bytes = 0;  // 累计发送完成字节数(中断)
+
+// 发送缓冲池，发送完成后由中断归还
+static uint8_t g4_tx_pool[G4_TX_POOL][G4_TX_BUF_SIZE];
+static volatile uint8_t g4_tx_pool_used[G4_TX_POOL];
+
+// 天气响应解析：三个字段(位0城市/位1天气/位2温度)齐全才提交到g4_weather
+static JSON_ParserTypeDef g4_weather_parser;
+static Weather_TypeDef g4_weather_new;
+static uint8_t g4_weather_fields = 0;
+
+// MQTT下行消息解析，属性设置先记下，整条消息结束后再生效
+static JSON_ParserTypeDef g4_mqtt_parser;
+static struct {
+    uint8_t is_set;                                 // method为属性设置
+    int16_t threshold[WATER_CHANNELS];              // 下发的阈值，-1未下发
+    uint8_t threshold_bad;                          // 阈值格式错误(位图)
+    CALIB_Point_TypeDef points[WATER_CHANNELS][CALIB_MAX_POINTS];
+    uint32_t calib_filled[WATER_CHANNELS];          // 已收到的标定点数值(每点两位)
+    uint8_t calib_count[WATER_CHANNELS];            // 标定点数
+    uint8_t calib_bad;                              // 标定表格式错误(位图)
+} g4_mqtt_set;
 
 // 假设4G模块连接到USART2，如果不是，请修改以下宏定义
 #define G4_UART &huart2
@@ -18,6 +65,15 @@ Weather_TypeDef g4_weather = {0};
 
 MQTT_State g4_mqtt_state = MQTT_DISCONNECTED;
 
+static const char* G4_FindStr(const char* data, uint16_t len, const char* key);
+static void G4_OnLine(FRAMER_TypeDef *f, const char *line, uint16_t len);
+static void G4_OnData(FRAMER_TypeDef *f, const uint8_t *data, uint16_t len, FRAMER_End end);
+static void G4_AT_Next(void);
+static void G4_AT_Poll(void);
+static void G4_WeatherJsonEvent(JSON_ParserTypeDef *p, JSON_Type type, const char *value, uint8_t len);
+static void G4_MQTTJsonEvent(JSON_ParserTypeDef *p, JSON_Type type, const char *value, uint8_t len);
+static void G4_MQTTResetSet(void);
+
 /**
   * @brief  初始化4G模块通信
   * @retval None
@@ -25,16 +81,29 @@ MQTT_State g4_mqtt_state = MQTT_DISCONNECTED;
 void G4_Init(void)
 {
     // 清空接收缓冲区
-    memset(g4_rx_buffer, 0, UART_RX_BUFFER_SIZE);
-    g4_rx_len = 0;
-    g4_rx_state = UART_IDLE;
+    RING_Init(&g4_rx_ring, g4_rx_buffer, UART_RX_BUFFER_SIZE);
+    RING_AttachDMA(&g4_rx_ring, G4_UART_HANDLE.hdmarx);
+    FRAMER_Init(&g4_framer, G4_OnLine, G4_OnData, NULL);
+    g4_rx_clear = 0;
+    g4_at_phase = G4_AT_IDLE;
+    g4_tx_in = 0;
+    g4_tx_out = 0;
+    g4_tx_busy = 0;
+    memset((void *)g4_tx_pool_used, 0, sizeof(g4_tx_pool_used));
+    JSON_Init(&g4_weather_parser, G4_WeatherJsonEvent, NULL);
+    JSON_Init(&g4_mqtt_parser, G4_MQTTJsonEvent, NULL);
+    G4_MQTTResetSet();
     
     // 使能串口接收空闲中断
     __HAL_UART_ENABLE_IT(G4_UART, UART_IT_IDLE);
     
-    // 启动DMA接收
+    // 启动循环DMA接收，之后一直运行，不再停止和重启
     HAL_UART_Receive_DMA(G4_UART, g4_rx_buffer, UART_RX_BUFFER_SIZE);
     
+    // 关闭错误中断：DMA接收模式下HAL把噪声/帧错误当作致命错误并中止接收，
+    // 个别错字节交给上层解析处理，接收不能因此停下
+    CLEAR_BIT(G4_UART_HANDLE.Instance->CR3, USART_CR3_EIE);
+    
     // 标记天气数据未更新
     g4_weather.updated = 0;
     
@@ -43,106 +112,284 @@ void G4_Init(void)
 }
 
 /**
-  * @brief  发送AT命令到4G模块
-  * @param  cmd: 要发送的AT命令字符串
+  * @brief  释放发送队首：统计、归还缓冲池、通知调用者
   * @retval None
+  * @note   在发送完成中断中调用；队列空闲时也可能在主循环中调用，此时没有DMA在发送
   */
-void G4_SendCmd(const char* cmd)
+static void G4_TxRelease(void)
 {
-    // 清空接收缓冲区，准备接收新数据
-    G4_ClearBuffer();
+    G4_TxDesc_TypeDef *desc = &g4_tx_queue[g4_tx_out % G4_TX_QUEUE];
     
-    // 发送命令
-    HAL_UART_Transmit(G4_UART, (uint8_t*)cmd, strlen(cmd), 100);
+    g4_tx_sent_bytes += desc->len;
+    if (desc->data >= g4_tx_pool[0] && desc->data < g4_tx_pool[G4_TX_POOL]) {
+        g4_tx_pool_used[(desc->data - g4_tx_pool[0]) / G4_TX_BUF_SIZE] = 0;
+    }
+    if (desc->done) {
+        desc->done(desc->data);
+    }
+    g4_tx_out++;
+}
+
+/**
+  * @brief  用DMA发送队首，队列空时标记空闲
+  * @retval None
+  */
+static void G4_TxStart(void)
+{
+    while (g4_tx_out != g4_tx_in) {
+        G4_TxDesc_TypeDef *desc = &g4_tx_queue[g4_tx_out % G4_TX_QUEUE];
+        if (HAL_UART_Transmit_DMA(G4_UART, (uint8_t *)desc->data, desc->len) == HAL_OK) {
+            return;
+        }
+        // 启动失败则丢弃这一条，继续下一条
+        G4_TxRelease();
+    }
+    g4_tx_busy = 0;
+}
+
+/**
+  * @brief  从发送缓冲池取一块缓冲区
+  * @retval 缓冲区(G4_TX_BUF_SIZE字节)，池已用完返回NULL
+  * @note   交给G4_Send发送后自动归还，不需要也不能再使用
+  */
+uint8_t* G4_TxAlloc(void)
+{
+    for (uint8_t i = 0; i < G4_TX_POOL; i++) {
+        if (!g4_tx_pool_used[i]) {
+            g4_tx_pool_used[i] = 1;
+            return g4_tx_pool[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+  * @brief  数据加入发送队列，立即返回
+  * @param  data: 数据，只保存指针，发送完成前必须保持有效
+  * @param  len: 长度
+  * @param  done: 发送完成回调(在中断中调用)，可为NULL
+  * @retval HAL_OK 已入队，HAL_BUSY 队列已满
+  * @note   缓冲池缓冲区无论成功与否都由发送队列归还
+  */
+HAL_StatusTypeDef G4_Send(const uint8_t* data, uint16_t len, void (*done)(const uint8_t* data))
+{
+    if ((uint8_t)(g4_tx_in - g4_tx_out) >= G4_TX_QUEUE) {
+        if (data >= g4_tx_pool[0] && data < g4_tx_pool[G4_TX_POOL]) {
+            g4_tx_pool_used[(data - g4_tx_pool[0]) / G4_TX_BUF_SIZE] = 0;
+        }
+        SEGGER_RTT_printf(0, "4G tx queue full\n");
+        return HAL_BUSY;
+    }
+    
+    G4_TxDesc_TypeDef *desc = &g4_tx_queue[g4_tx_in % G4_TX_QUEUE];
+    desc->data = data;
+    desc->len = len;
+    desc->done = done;
+    g4_tx_queued_bytes += len;
+    g4_tx_in++;
+    
+    // DMA空闲时由这里启动，否则由发送完成中断接着发送
+    if (!g4_tx_busy) {
+        g4_tx_busy = 1;
+        G4_TxStart();
+    }
+    return HAL_OK;
+}
+
+/**
+  * @brief  发送队列中尚未发送完成的条数(含正在发送的一条)
+  * @retval 条数
+  */
+uint8_t G4_GetTxDepth(void)
+{
+    return g4_tx_in - g4_tx_out;
+}
+
+/**
+  * @brief  已入队但尚未发送完成的字节数
+  * @retval 字节数
+  */
+uint32_t G4_GetTxInFlight(void)
+{
+    return g4_tx_queued_bytes - g4_tx_sent_bytes;
+}
+
+/**
+  * @brief  串口DMA发送完成回调，接着发送下一条
+  * @param  huart: 串口句柄
+  * @retval None
+  */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->Instance == G4_UART_HANDLE.Instance)
+    {
+        G4_TxRelease();
+        G4_TxStart();
+    }
+}
+
+/**
+  * @brief  发送AT命令到4G模块，立即返回
+  * @param  cmd: 要发送的AT命令字符串，只保存指针，发送完成前必须保持有效(常量字符串)
+  * @retval HAL_OK 已入队，HAL_BUSY 发送队列已满
+  */
+HAL_StatusTypeDef G4_SendCmd(const char* cmd)
+{
+    // 丢弃之前未处理的数据，只等待本命令的响应
+    G4_ClearBuffer();
     
-    // 设置接收状态为接收中
-    g4_rx_state = UART_RECEIVING;
+    // 加入发送队列
+    return G4_Send((const uint8_t*)cmd, strlen(cmd), NULL);
 }
 
 /**
-  * @brief  检查是否收到数据
-  * @retval 1: 已收到数据，0: 未收到数据
+  * @brief  累计因处理不及时被覆盖的字节数
+  * @retval 字节数
   */
-uint8_t G4_IsDataReceived(void)
+uint32_t G4_GetDroppedBytes(void)
 {
-    return (g4_rx_state == UART_RECEIVED) ? 1 : 0;
+    return g4_rx_ring.dropped;
 }
 
 /**
-  * @brief  获取接收数据长度
-  * @retval 接收数据长度
+  * @brief  响应行：日志，并与当前AT步骤期望的响应比较
+  * @param  f: 分帧器
+  * @param  line: 行内容(以0结尾)
+  * @param  len: 长度
+  * @retval None
   */
-uint16_t G4_GetDataLength(void)
+static void G4_OnLine(FRAMER_TypeDef *f, const char *line, uint16_t len)
 {
-    return g4_rx_len;
+    SEGGER_RTT_printf(0, "receive: %s\n", line);
+    
+    if (g4_at_phase == G4_AT_WAIT) {
+        const G4_ATStep_TypeDef *step = &g4_at_steps[g4_at_index];
+        if (step->expect && G4_FindStr(line, len, step->expect)) {
+            G4_AT_Next();
+        }
+    }
 }
 
 /**
-  * @brief  获取接收缓冲区指针
-  * @retval 接收缓冲区指针
+  * @brief  透传JSON：交给当前AT步骤的响应处理，否则按MQTT下行消息处理
+  * @param  f: 分帧器
+  * @param  data: JSON片段，直接指向接收环形区
+  * @param  len: 长度
+  * @param  end: 片段状态
+  * @retval None
   */
-uint8_t* G4_GetRxBuffer(void)
+static void G4_OnData(FRAMER_TypeDef *f, const uint8_t *data, uint16_t len, FRAMER_End end)
 {
-    return g4_rx_buffer;
+    if (end == FRAMER_ABORT) {
+        // 半截消息作废
+        SEGGER_RTT_printf(0, "receive: payload timeout\n");
+        if (g4_at_phase == G4_AT_WAIT && g4_at_steps[g4_at_index].handler) {
+            g4_at_steps[g4_at_index].handler(NULL, 0);
+        }
+        JSON_Reset(&g4_mqtt_parser);
+        return;
+    }
+    
+    SEGGER_RTT_printf(0, "receive(%d bytes): ", len);
+    SEGGER_RTT_Write(0, data, len);
+    SEGGER_RTT_printf(0, "\n");
+    
+    if (g4_at_phase == G4_AT_WAIT && g4_at_steps[g4_at_index].handler) {
+        if (g4_at_steps[g4_at_index].handler((const char *)data, len)) {
+            G4_AT_Next();
+        }
+    } else if (g4_mqtt_state == MQTT_CONNECTED) {
+        G4_ProcessMQTTData((const char *)data, len);
+    }
 }
 
 /**
-  * @brief  处理接收到的数据
+  * @brief  处理接收到的数据，推进AT命令脚本，在主循环中调用
   * @retval None
+  * @note   不阻塞：新收到的字节直接在环形区上分帧并分发，每字节只处理一次；
+  *         MQTT断开时按G4_RETRY_MS间隔重新连接
   */
 void G4_ProcessData(void)
 {
-    // 处理4G模块接收到的数据
-    if (G4_IsDataReceived())
-    {
-        // 获取接收缓冲区和长度
-        uint8_t* rx_data = G4_GetRxBuffer();
-        uint16_t rx_len = G4_GetDataLength();
-        
-        SEGGER_RTT_printf(0, "receive(%d bytes): %s\n", rx_len, (char*)rx_data);
-        
-        // 检查是否是MQTT消息
-        if (g4_mqtt_state == MQTT_CONNECTED) {
-            G4_ProcessMQTTData((const char *)rx_data, rx_len);
+    const uint8_t *data;
+    uint16_t len;
+    
+    while (1) {
+        // 发送命令之前收到的数据作废
+        if (g4_rx_clear) {
+            int32_t stale = (int32_t)(g4_rx_clear_to - g4_rx_ring.tail);
+            g4_rx_clear = 0;
+            if (stale > 0 && (uint32_t)stale <= RING_Count(&g4_rx_ring)) {
+                RING_Skip(&g4_rx_ring, stale);
+            }
         }
         
-        // 清除缓冲区，准备下一次接收
-        G4_ClearBuffer();
+        len = RING_Peek(&g4_rx_ring, &data);
+        if (len == 0) {
+            break;
+        }
+        if (RING_Skip(&g4_rx_ring, FRAMER_Feed(&g4_framer, data, len, TIMER_GetTick())) != HAL_OK) {
+            // 分帧期间DMA已覆盖了这批数据，当前帧不完整，从下一帧重新开始
+            SEGGER_RTT_printf(0, "4G rx overrun\n");
+            FRAMER_Reset(&g4_framer);
+        }
+    }
+    FRAMER_Poll(&g4_framer, TIMER_GetTick());
+    
+    if (g4_at_phase != G4_AT_IDLE) {
+        G4_AT_Poll();
+    } else if (g4_mqtt_state == MQTT_DISCONNECTED && TIMER_GetTick() - g4_retry_tick >= G4_RETRY_MS) {
+        // 重新连接前先补取天气，天气脚本结束后自动连接MQTT
+        if (!g4_weather.updated) {
+            G4_GetWeather();
+        } else {
+            G4_InitMQTT();
+        }
     }
 }
 
 /**
   * @brief  清空接收缓冲区
+  * @note   只丢弃到此刻为止已收到未处理的数据，DMA接收不停止，之后到达的字节不受影响；
+  *         可以在分帧处理函数中调用，当前这批数据的剩余部分随之丢弃
   * @retval None
   */
 void G4_ClearBuffer(void)
 {
-    memset(g4_rx_buffer, 0, UART_RX_BUFFER_SIZE);
-    g4_rx_len = 0;
-    g4_rx_state = UART_IDLE;
-    
-    // 重启DMA接收
-    HAL_UART_AbortReceive(G4_UART);
-    HAL_UART_Receive_DMA(G4_UART, g4_rx_buffer, UART_RX_BUFFER_SIZE);
+    FRAMER_Reset(&g4_framer);
+    g4_rx_clear_to = g4_rx_ring.head;
+    g4_rx_clear = 1;
 }
 
 /**
-  * @brief  串口中断回调函数(需要放在stm32f1xx_it.c或main.c中)
+  * @brief  DMA接收全满回调，循环模式下每转一圈触发一次
   * @param  huart: 串口句柄
   * @retval None
   */
 void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
 {
-    // DMA接收完成回调，通常不会触发，因为设置的接收长度比较大
     if (huart->Instance == G4_UART_HANDLE.Instance)
     {
-        g4_rx_state = UART_RECEIVED;
-        g4_rx_len = UART_RX_BUFFER_SIZE;
+        RING_Produce(&g4_rx_ring, UART_RX_BUFFER_SIZE - __HAL_DMA_GET_COUNTER(huart->hdmarx));
     }
 }
 
 /**
-  * @brief  串口空闲中断处理
+  * @brief  DMA接收半满回调
+  * @param  huart: 串口句柄
+  * @retval None
+  * @note   与全满、空闲中断一起保证两次推进之间DMA写入不超过半圈
+  */
+void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->Instance == G4_UART_HANDLE.Instance)
+    {
+        RING_Produce(&g4_rx_ring, UART_RX_BUFFER_SIZE - __HAL_DMA_GET_COUNTER(huart->hdmarx));
+    }
+}
+
+/**
+  * @brief  串口空闲中断处理，一次连续接收结束，推进写位置
   * @note   需要在stm32f1xx_it.c的USARTx_IRQHandler中调用此函数
   * @retval None
   */
@@ -153,229 +400,320 @@ void G4_UART_IDLECallback(void)
         // 清除空闲中断标志
         __HAL_UART_CLEAR_IDLEFLAG(G4_UART);
         
-        // 停止DMA传输
-        HAL_UART_DMAStop(G4_UART);
-        
-        // 计算接收到的数据长度
-        g4_rx_len = UART_RX_BUFFER_SIZE - __HAL_DMA_GET_COUNTER(G4_UART_HANDLE.hdmarx);
-        
-        // 标记接收完成
-        g4_rx_state = UART_RECEIVED;
-        
-        // 重启DMA接收
-        HAL_UART_Receive_DMA(G4_UART, g4_rx_buffer, UART_RX_BUFFER_SIZE);
+        // 推进写位置
+        RING_Produce(&g4_rx_ring, UART_RX_BUFFER_SIZE - __HAL_DMA_GET_COUNTER(G4_UART_HANDLE.hdmarx));
     }
 }
 
-// 修改为阻塞式获取天气函数
-HAL_StatusTypeDef G4_GetWeather(void)
-{  
-    // 构建HTTP GET请求
-    const char* request = "GET https://api.seniverse.com/v3/weather/now.json?key=SQNlQOMv_LBPmUraM&location=Guilin&language=en&unit=c\r\n";
-    
-    // 发送请求前清空状态
-    g4_weather.updated = 0;
+// 天气请求(透传模式下直接发送HTTP请求行)
+static const char g4_weather_request[] = "GET https://api.seniverse.com/v3/weather/now.json?key=SQNlQOMv_LBPmUraM&location=Guilin&language=en&unit=c\r\n";
 
-    // 显示初始化中 
-    OLED_Clear();
-    char title[] = "City Weather";
-    uint8_t title_x = (128 - strlen(title) * 8) / 2;
-    OLED_ShowString(title_x, 2, title, 16);
-    OLED_ShowString(24, 4, "Getting", 16);
+// 获取天气：切换到HTTP任务并复位，等4G连接后发请求，收到能解析的天气JSON为止
+static const G4_ATStep_TypeDef g4_weather_steps[] = {
+    {"AT+DTUTASK=\"1\",\"10\"\r\n", "OK", 200, 0, G4_AT_OPTIONAL, NULL},
+    {"AT+REST\r\n", NULL, 200, 0, 0, NULL},                           // 等待模块复位
+    {g4_weather_request, NULL, 2000, 10, G4_AT_WAIT_LINK, G4_ParseWeatherJson},
+};
 
-    // 发送初始化命令
-    G4_SendCmd("AT+DTUTASK=\"1\",\"10\"\r\n");
-    HAL_Delay(200); // 等待响应
-    
-    G4_SendCmd("AT+REST\r\n");
-    HAL_Delay(200); // 等待模块复位
+// 连接MQTT：切换到MQTT任务并复位，4G连接建立即认为MQTT已连接
+static const G4_ATStep_TypeDef g4_mqtt_steps[] = {
+    {"AT+DTUTASK=\"1\",\"20\"\r\n", "OK", 200, 0, G4_AT_OPTIONAL, NULL},
+    {"AT+REST\r\n", NULL, 200, 0, 0, NULL},                           // 等待模块复位
+    {NULL, NULL, 0, 0, G4_AT_WAIT_LINK, NULL},
+};
 
+/**
+  * @brief  当前步骤是否还需要等待4G连接
+  * @retval 1: 需要等待，0: 不需要
+  */
+static uint8_t G4_AT_NeedLink(void)
+{
+    return (g4_at_steps[g4_at_index].flags & G4_AT_WAIT_LINK) && !g4_connected;
+}
+
+/**
+  * @brief  发出当前步骤的命令，开始等待响应
+  * @retval None
+  */
+static void G4_AT_Send(void)
+{
+    const G4_ATStep_TypeDef *step = &g4_at_steps[g4_at_index];
     
-    uint32_t retry_count = 0;
-    uint8_t first_time = 1;
-    // 等待接收数据时添加动态效果
-    uint8_t dots = 0, cnt = 0;
-    char dot_text[4] = {0};
+    if (step->handler) {
+        step->handler(NULL, 0); // 响应处理复位，丢弃上一次发送解析到一半的数据
+    }
+    if (step->cmd) {
+        G4_SendCmd(step->cmd);
+    }
+    g4_at_phase = G4_AT_WAIT;
+    g4_at_tick = TIMER_GetTick();
+}
+
+/**
+  * @brief  开始执行当前步骤
+  * @retval None
+  */
+static void G4_AT_Enter(void)
+{
+    g4_at_tries = 0;
+    g4_at_tick = TIMER_GetTick();
+    if (G4_AT_NeedLink()) {
+        g4_at_phase = G4_AT_LINK;
+    } else {
+        G4_AT_Send();
+    }
+}
+
+/**
+  * @brief  结束脚本并通知调用者
+  * @param  status: HAL_OK全部步骤完成，HAL_TIMEOUT某一步超时
+  * @retval None
+  */
+static void G4_AT_Finish(HAL_StatusTypeDef status)
+{
+    void (*done)(HAL_StatusTypeDef) = g4_at_done;
     
-    while (!g4_weather.updated)
-    {
-        // 超时重发
-        if (g4_connected == 1 && (first_time || ++retry_count % 20 == 0)) {
-            retry_count = 0;
-            first_time = 0;
-            // 发送请求
-            G4_SendCmd(request);
-            SEGGER_RTT_printf(0, "send weather request\n");
-        }
+    g4_at_phase = G4_AT_IDLE;
+    g4_at_done = NULL;
+    if (done) {
+        done(status);
+    }
+}
 
-        // 处理接收到的数据
-        if (G4_IsDataReceived())
-        {
-            // 获取接收缓冲区和长度
-            uint8_t* rx_data = G4_GetRxBuffer();
-            uint16_t rx_len = G4_GetDataLength();
-            
-            SEGGER_RTT_printf(0, "receive(%d bytes): %s\n", rx_len, (char*)rx_data);
-            
-            // 尝试解析JSON数据
-            if (strstr((char*)rx_data, "\"results\":")) {
-                if (G4_ParseWeatherJson((char*)rx_data)) {
-                    // 解析成功
-                    G4_ClearBuffer();
-                    return HAL_OK;
-                }
-            }
-            
-            // 清除缓冲区，准备继续接收
-            // G4_ClearBuffer();
-            g4_rx_state = UART_IDLE;
-        }
-        
-        // 小延时，避免过度占用CPU
-        HAL_Delay(100);
+/**
+  * @brief  进入下一步，最后一步完成时结束脚本
+  * @retval None
+  */
+static void G4_AT_Next(void)
+{
+    if (++g4_at_index >= g4_at_count) {
+        G4_AT_Finish(HAL_OK);
+    } else {
+        G4_AT_Enter();
+    }
+}
 
-        // 每200ms更新一次动画
-        if (++cnt >= 2) {
-            cnt = 0;
-            
-            // 更新动态点数量 (0-3)
-            dots = (dots + 1) % 4;
-            
-            // 生成点的文本
-            memset(dot_text, 0, sizeof(dot_text));
-            for (int i = 0; i < dots; i++) {
-                dot_text[i] = '.';
-            }
-            
-            // 更新显示点
-            OLED_ShowString(80, 4, "   ", 16); // 清除之前的点
-            OLED_ShowString(80, 4, dot_text, 16);
-        }
+/**
+  * @brief  开始执行一个AT命令脚本，立即返回，由G4_ProcessData推进
+  * @param  steps: 步骤表
+  * @param  count: 步骤数
+  * @param  done: 结束回调，可为NULL
+  * @retval HAL_OK 已开始，HAL_BUSY 上一个脚本尚未结束
+  */
+static HAL_StatusTypeDef G4_AT_Start(const G4_ATStep_TypeDef *steps, uint8_t count,
+                                     void (*done)(HAL_StatusTypeDef))
+{
+    if (g4_at_phase != G4_AT_IDLE) {
+        return HAL_BUSY;
     }
     
+    g4_at_steps = steps;
+    g4_at_count = count;
+    g4_at_index = 0;
+    g4_at_done = done;
+    G4_AT_Enter();
     return HAL_OK;
 }
 
-// 添加JSON解析函数
-uint8_t G4_ParseWeatherJson(const char* json_data)
+/**
+  * @brief  检查当前步骤的等待条件和超时
+  * @retval None
+  */
+static void G4_AT_Poll(void)
 {
-    // 简单的JSON解析逻辑，提取需要的字段
-    char* name_pos = strstr(json_data, "\"name\":\"");
-    char* text_pos = strstr(json_data, "\"text\":\"");
-    char* temp_pos = strstr(json_data, "\"temperature\":\"");
+    const G4_ATStep_TypeDef *step = &g4_at_steps[g4_at_index];
+    uint32_t elapsed = TIMER_GetTick() - g4_at_tick;
     
-    if (name_pos && text_pos && temp_pos) {
-        // 提取城市名称
-        name_pos += 8; // 跳过 "name":"
-        int i = 0;
-        while (*name_pos != '"' && i < sizeof(g4_weather.city)-1) {
-            g4_weather.city[i++] = *name_pos++;
-        }
-        g4_weather.city[i] = '\0';
-        
-        // 提取天气描述
-        text_pos += 8; // 跳过 "text":"
-        i = 0;
-        while (*text_pos != '"' && i < sizeof(g4_weather.text)-1) {
-            g4_weather.text[i++] = *text_pos++;
+    if (g4_at_phase == G4_AT_LINK) {
+        if (g4_connected) {
+            G4_AT_Send();
+        } else if (elapsed >= G4_LINK_TIMEOUT_MS) {
+            if (step->flags & G4_AT_OPTIONAL) {
+                G4_AT_Next();
+            } else {
+                G4_AT_Finish(HAL_TIMEOUT);
+            }
         }
-        g4_weather.text[i] = '\0';
-        
-        // 提取温度
-        temp_pos += 15; // 跳过 "temperature":"
-        i = 0;
-        while (*temp_pos != '"' && i < sizeof(g4_weather.temperature)-1) {
-            g4_weather.temperature[i++] = *temp_pos++;
+    } else if (g4_at_phase == G4_AT_WAIT && elapsed >= step->timeout_ms) {
+        if (!step->expect && !step->handler) {
+            // 不检查响应的步骤，等够时间即完成
+            G4_AT_Next();
+        } else if (g4_at_tries < step->retries) {
+            // 超时重发，4G断开时先等连接恢复
+            g4_at_tries++;
+            g4_at_tick = TIMER_GetTick();
+            if (G4_AT_NeedLink()) {
+                g4_at_phase = G4_AT_LINK;
+            } else {
+                G4_AT_Send();
+            }
+        } else if (step->flags & G4_AT_OPTIONAL) {
+            G4_AT_Next();
+        } else {
+            G4_AT_Finish(HAL_TIMEOUT);
         }
-        g4_weather.temperature[i] = '\0';
-        
-        // 标记更新完成
-        g4_weather.updated = 1;
-        
-        SEGGER_RTT_printf(0, "weather update success: %s, %s, %s°C\n", 
-                         g4_weather.city, g4_weather.text, g4_weather.temperature);
-        
-        return 1;
     }
-    
-    SEGGER_RTT_printf(0, "parse weather data failed\n");
-    return 0;
 }
 
 /**
-  * @brief  初始化MQTT连接
-  * @param  force_wait: 是否强制等待连接建立
-  * @retval HAL状态
+  * @brief  AT命令脚本是否正在执行
+  * @retval 1: 正在执行，0: 空闲
   */
-HAL_StatusTypeDef G4_InitMQTT(uint8_t force_wait)
-{   
-    // 设置MQTT模式
-    g4_mqtt_state = MQTT_CONNECTING;
-
-    // 显示初始化中 
-    OLED_Clear();
-    char title[] = "aliyun MQTT";
-    uint8_t title_x = (128 - strlen(title) * 8) / 2;
-    OLED_ShowString(title_x, 2, title, 16);
-    OLED_ShowString(16, 4, "Connecting", 16);
-    
-    // 发送切换到MQTT模式命令
-    G4_SendCmd("AT+DTUTASK=\"1\",\"20\"\r\n");
-    HAL_Delay(200); // 等待响应
-    
-    G4_SendCmd("AT+REST\r\n");
-    HAL_Delay(200); // 等待模块复位
-    
-    SEGGER_RTT_printf(0, "send MQTT initialization command\n");
+uint8_t G4_IsBusy(void)
+{
+    return (g4_at_phase != G4_AT_IDLE) ? 1 : 0;
+}
+
+/**
+  * @brief  天气脚本结束：无论成功与否接着连接MQTT
+  * @param  status: 脚本结果
+  * @retval None
+  */
+static void G4_WeatherDone(HAL_StatusTypeDef status)
+{
+    if (status != HAL_OK) {
+        SEGGER_RTT_printf(0, "weather request timeout\n");
+    }
+    G4_InitMQTT();
+}
+
+/**
+  * @brief  MQTT脚本结束
+  * @param  status: 脚本结果
+  * @retval None
+  */
+static void G4_MQTTDone(HAL_StatusTypeDef status)
+{
+    if (status == HAL_OK) {
+        g4_mqtt_state = MQTT_CONNECTED;
+        SEGGER_RTT_printf(0, "MQTT connected\n");
+    } else {
+        g4_mqtt_state = MQTT_DISCONNECTED;
+        g4_retry_tick = TIMER_GetTick();
+        SEGGER_RTT_printf(0, "MQTT connection timeout\n");
+    }
+}
+
+/**
+  * @brief  开始获取天气，立即返回
+  * @retval HAL_OK 已开始，HAL_BUSY 有脚本正在执行
+  * @note   结果写入g4_weather；结束后自动连接MQTT
+  */
+HAL_StatusTypeDef G4_GetWeather(void)
+{
+    HAL_StatusTypeDef status;
     
-    // 等待连接建立，设置30秒超时
-    uint32_t start_time = TIMER_GetTick();
-    uint32_t timeout = 30000; // 30秒超时
-    // 等待接收数据时添加动态效果
-    uint8_t dots = 0, cnt = 0;
-    char dot_text[4] = {0};
+    g4_weather.updated = 0;
+    status = G4_AT_Start(g4_weather_steps, sizeof(g4_weather_steps) / sizeof(g4_weather_steps[0]), G4_WeatherDone);
+    if (status == HAL_OK) {
+        g4_mqtt_state = MQTT_DISCONNECTED;
+        SEGGER_RTT_printf(0, "send weather request\n");
+    }
+    return status;
+}
+
+/**
+  * @brief  在定长数据中查找字符串
+  * @param  data: 数据，不要求以0结尾
+  * @param  len: 数据长度
+  * @param  key: 要查找的字符串
+  * @retval 首次出现的位置，未找到返回NULL
+  */
+static const char* G4_FindStr(const char* data, uint16_t len, const char* key)
+{
+    uint16_t key_len = strlen(key);
     
-    while (g4_mqtt_state != MQTT_CONNECTED)
-    {
-        // 如果设备已连接，认为MQTT也连接上了
-        if (g4_connected) {
-            g4_mqtt_state = MQTT_CONNECTED;
-            SEGGER_RTT_printf(0, "MQTT connected\n");
-            return HAL_OK;
-        }
-        
-        // 检查是否超时
-        if (!force_wait && TIMER_GetTick() - start_time > timeout) {
-            SEGGER_RTT_printf(0, "MQTT connection timeout\n");
-            g4_mqtt_state = MQTT_DISCONNECTED;
-            return HAL_TIMEOUT;
+    for (uint16_t i = 0; i + key_len <= len; i++) {
+        if (data[i] == key[0] && memcmp(data + i, key, key_len) == 0) {
+            return data + i;
         }
+    }
+    return NULL;
+}
 
-        G4_ProcessData();
-        
-        // 小延时，避免过度占用CPU
-        HAL_Delay(100);
+/**
+  * @brief  复制一个字符串字段，超长截断
+  * @param  dst: 目标
+  * @param  size: 目标大小
+  * @param  value: 字段值(以0结尾)
+  * @param  len: 字段长度
+  * @retval None
+  */
+static void G4_CopyField(char* dst, uint8_t size, const char* value, uint8_t len)
+{
+    if (len > size - 1) {
+        len = size - 1;
+    }
+    memcpy(dst, value, len);
+    dst[len] = '\0';
+}
 
-        // 每200ms更新一次动画
-        if (++cnt >= 2) {
-            cnt = 0;
-            
-            // 更新动态点数量 (0-3)
-            dots = (dots + 1) % 4;
-            
-            // 生成点的文本
-            memset(dot_text, 0, sizeof(dot_text));
-            for (int i = 0; i < dots; i++) {
-                dot_text[i] = '.';
-            }
+/**
+  * @brief  天气JSON解析事件：按路径取城市、天气和温度，整个文档结束且三项齐全才更新
+  * @retval None
+  */
+static void G4_WeatherJsonEvent(JSON_ParserTypeDef *p, JSON_Type type, const char *value, uint8_t len)
+{
+    if (type == JSON_STRING) {
+        if (JSON_PathIs(p, "results.location.name")) {
+            G4_CopyField(g4_weather_new.city, sizeof(g4_weather_new.city), value, len);
+            g4_weather_fields |= 0x01;
+        } else if (JSON_PathIs(p, "results.now.text")) {
+            G4_CopyField(g4_weather_new.text, sizeof(g4_weather_new.text), value, len);
+            g4_weather_fields |= 0x02;
+        } else if (JSON_PathIs(p, "results.now.temperature")) {
+            G4_CopyField(g4_weather_new.temperature, sizeof(g4_weather_new.temperature), value, len);
+            g4_weather_fields |= 0x04;
+        }
+    } else if (type == JSON_END || type == JSON_ERROR) {
+        if (type == JSON_END && g4_weather_fields == 0x07) {
+            memcpy(g4_weather.city, g4_weather_new.city, sizeof(g4_weather.city));
+            memcpy(g4_weather.text, g4_weather_new.text, sizeof(g4_weather.text));
+            memcpy(g4_weather.temperature, g4_weather_new.temperature, sizeof(g4_weather.temperature));
+            g4_weather.updated = 1;
             
-            // 更新显示点
-            OLED_ShowString(94, 4, "   ", 16); // 清除之前的点
-            OLED_ShowString(94, 4, dot_text, 16);
+            SEGGER_RTT_printf(0, "weather update success: %s, %s, %s°C\n", 
+                             g4_weather.city, g4_weather.text, g4_weather.temperature);
+        } else {
+            SEGGER_RTT_printf(0, "parse weather data failed\n");
         }
+        g4_weather_fields = 0;
+    }
+}
+
+/**
+  * @brief  解析天气响应，可分段喂入
+  * @param  json_data: 响应片段，NULL表示即将(重新)发送请求，丢弃解析到一半的数据
+  * @param  len: 片段长度
+  * @retval 1: 已得到完整的天气数据，0: 还没有
+  */
+uint8_t G4_ParseWeatherJson(const char* json_data, uint16_t len)
+{
+    if (json_data == NULL) {
+        JSON_Reset(&g4_weather_parser);
+        g4_weather_fields = 0;
+        return 0;
     }
     
-    return HAL_OK;
+    JSON_Feed(&g4_weather_parser, json_data, len);
+    return g4_weather.updated;
+}
+
+/**
+  * @brief  开始连接MQTT，立即返回
+  * @retval HAL_OK 已开始，HAL_BUSY 有脚本正在执行
+  * @note   连接结果由g4_mqtt_state反映，超时后G4_ProcessData每G4_RETRY_MS重试一次
+  */
+HAL_StatusTypeDef G4_InitMQTT(void)
+{
+    HAL_StatusTypeDef status;
+    
+    status = G4_AT_Start(g4_mqtt_steps, sizeof(g4_mqtt_steps) / sizeof(g4_mqtt_steps[0]), G4_MQTTDone);
+    if (status == HAL_OK) {
+        g4_mqtt_state = MQTT_CONNECTING;
+        SEGGER_RTT_printf(0, "send MQTT initialization command\n");
+    }
+    return status;
 }
 
 /**
@@ -388,55 +726,175 @@ HAL_StatusTypeDef G4_UploadData(void)
         return HAL_ERROR;
     }
     
-    // 构建JSON数据，符合阿里云格式
-    char json_data[256];
+    // 构建JSON数据，符合阿里云格式；拼装在发送缓冲池中，发送完成后自动归还
+    char* json_data = (char*)G4_TxAlloc();
+    if (json_data == NULL) {
+        return HAL_BUSY;
+    }
+    int len = sprintf(json_data, "{\"params\":{");
+    
+    // 通道0沿用water_ratio/water_threshold，其余通道加_2、_3...后缀
+    for (uint8_t ch = 0; ch < WATER_CHANNELS; ch++) {
+        char suffix[4] = "";
+        if (ch > 0) {
+            sprintf(suffix, "_%d", ch + 1);
+        }
+        len += sprintf(json_data + len, "%s\"water_ratio%s\":%d,\"water_threshold%s\":%d",
+                       ch ? "," : "",
+                       suffix, WATER_GetCurrentLevel(ch),
+                       suffix, FLASH_GetWaterThreshold(ch));
+    }
+    
     if (g4_weather.updated) {
-        sprintf(json_data, "{\"params\":{\"water_ratio\":%d,\"water_threshold\":%d,\"city\":\"%s\",\"weather\":\"%s\",\"temperature\":\"%s\"}}",
-                WATER_GetCurrentLevel(),
-                FLASH_GetWaterThreshold(),
+        len += sprintf(json_data + len, ",\"city\":\"%s\",\"weather\":\"%s\",\"temperature\":\"%s\"}}",
                 g4_weather.city,
                 g4_weather.text,
                 g4_weather.temperature);
     } else {
-            sprintf(json_data, "{\"params\":{\"water_ratio\":%d,\"water_threshold\":%d}}",
-                WATER_GetCurrentLevel(),
-                FLASH_GetWaterThreshold());
+        len += sprintf(json_data + len, "}}");
     }
 
-    // 发送JSON数据
-    G4_SendCmd(json_data);
+    // 发送JSON数据，透传模式下不清除接收，未处理的下行消息保留
     SEGGER_RTT_printf(0, "upload data\n");
     // SEGGER_RTT_printf(0, "upload data: %s\n", json_data);
+    return G4_Send((const uint8_t*)json_data, len, NULL);
 }
 
 /**
-  * @brief  处理MQTT接收到的数据
-  * @param  data: 接收到的数据
-  * @param  len: 数据长度
+  * @brief  属性键对应的通道
+  * @param  path: 值的路径，如"params.water_threshold_2"
+  * @param  key: 属性名(通道0)，如"params.water_threshold"
+  * @retval 通道号，不是该属性返回-1
+  * @note   通道0的属性名不带后缀，其余通道加_2、_3...后缀
+  */
+static int8_t G4_PropertyChannel(const char* path, const char* key)
+{
+    uint8_t key_len = strlen(key);
+    
+    if (strncmp(path, key, key_len) != 0) {
+        return -1;
+    }
+    path += key_len;
+    if (*path == '\0') {
+        return 0;
+    }
+    if (path[0] == '_' && path[1] >= '2' && path[1] < '1' + WATER_CHANNELS && path[2] == '\0') {
+        return path[1] - '1';
+    }
+    return -1;
+}
+
+/**
+  * @brief  清空属性设置的解析结果
   * @retval None
   */
-void G4_ProcessMQTTData(const char* data, uint16_t len)
+static void G4_MQTTResetSet(void)
 {
-    // 检查是否是阿里云的属性设置指令
-    if (strstr(data, "\"method\":\"thing.service.property.set\"")) {
-        // 查找水位阈值设置命令
-        char* threshold_pos = strstr(data, "\"water_threshold\":");
-        if (threshold_pos) {
-            // 提取阈值值
-            threshold_pos += 18; // 跳过 "water_threshold":
-            int new_threshold = atoi(threshold_pos);
-            
+    memset(&g4_mqtt_set, 0, sizeof(g4_mqtt_set));
+    for (uint8_t ch = 0; ch < WATER_CHANNELS; ch++) {
+        g4_mqtt_set.threshold[ch] = -1;
+    }
+}
+
+/**
+  * @brief  应用一条完整的属性设置消息
+  * @retval None
+  */
+static void G4_MQTTApplySet(void)
+{
+    for (uint8_t ch = 0; ch < WATER_CHANNELS; ch++) {
+        char suffix[4] = "";
+        if (ch > 0) {
+            sprintf(suffix, "_%d", ch + 1);
+        }
+        
+        // 水位阈值
+        int16_t new_threshold = g4_mqtt_set.threshold[ch];
+        if (new_threshold >= 0 || g4_mqtt_set.threshold_bad & (1 << ch)) {
             // 验证阈值范围
-            if (new_threshold > 0 && new_threshold <= 100) {
+            if (!(g4_mqtt_set.threshold_bad & (1 << ch)) && new_threshold > 0 && new_threshold <= 100) {
                 // 更新Flash中的阈值
-                if (FLASH_SetWaterThreshold(new_threshold) == HAL_OK) {
-                    SEGGER_RTT_printf(0, "update water threshold: %d\n", new_threshold);
+                if (FLASH_SetWaterThreshold(ch, new_threshold) == HAL_OK) {
+                    SEGGER_RTT_printf(0, "update water threshold%s: %d\n", suffix, new_threshold);
+                    WATER_RearmAlarm(ch); // 看门狗上限随阈值更新
                 } else {
-                    SEGGER_RTT_printf(0, "update water threshold failed\n");
+                    SEGGER_RTT_printf(0, "update water threshold%s failed\n", suffix);
                 }
             } else {
-                SEGGER_RTT_printf(0, "invalid water threshold: %d\n", new_threshold);
+                SEGGER_RTT_printf(0, "invalid water threshold%s\n", suffix);
+            }
+        }
+        
+        // 水位标定表：每个标定点的ADC值和百分比都要齐全
+        uint8_t count = g4_mqtt_set.calib_count[ch];
+        if (count || g4_mqtt_set.calib_bad & (1 << ch)) {
+            uint32_t full = (count >= 16) ? 0xFFFFFFFF : ((1UL << (count * 2)) - 1);
+            if (!(g4_mqtt_set.calib_bad & (1 << ch)) && g4_mqtt_set.calib_filled[ch] == full &&
+                CALIB_SetTable(ch, g4_mqtt_set.points[ch], count) == HAL_OK) {
+                SEGGER_RTT_printf(0, "update water calib%s: %d points\n", suffix, count);
+                WATER_RearmAlarm(ch); // 看门狗上限随标定表更新
+            } else {
+                SEGGER_RTT_printf(0, "invalid water calib%s\n", suffix);
             }
         }
     }
 }
+
+/**
+  * @brief  MQTT下行JSON解析事件
+  * @retval None
+  * @note   method可能出现在params之后，先把阈值和标定表记下，整条消息结束且method为属性设置时才生效
+  */
+static void G4_MQTTJsonEvent(JSON_ParserTypeDef *p, JSON_Type type, const char *value, uint8_t len)
+{
+    int8_t ch;
+    
+    if (type == JSON_END || type == JSON_ERROR) {
+        if (type == JSON_END && g4_mqtt_set.is_set) {
+            G4_MQTTApplySet();
+        }
+        G4_MQTTResetSet();
+        return;
+    }
+    
+    if (JSON_PathIs(p, "method")) {
+        g4_mqtt_set.is_set = (type == JSON_STRING && strcmp(value, "thing.service.property.set") == 0);
+    } else if ((ch = G4_PropertyChannel(p->path, "params.water_threshold")) >= 0) {
+        // 只接受0~100的整数，负数、小数和超出int16的值都按格式错误回报
+        char *end;
+        long threshold = strtol(value, &end, 10);
+        if (type == JSON_NUMBER && p->depth == 2 && *end == '\0' && threshold >= 0 && threshold <= 100) {
+            g4_mqtt_set.threshold[ch] = threshold;
+        } else {
+            g4_mqtt_set.threshold_bad |= 1 << ch;
+        }
+    } else if ((ch = G4_PropertyChannel(p->path, "params.water_calib")) >= 0) {
+        // 格式 [[adc,percent],[adc,percent],...]，数字位于第4层(根对象/params/外层数组/内层数组)
+        uint16_t k = JSON_Index(p, 1);
+        uint16_t i = JSON_Index(p, 0);
+        if (type != JSON_NUMBER || p->depth != 4 || k >= CALIB_MAX_POINTS || i > 1) {
+            g4_mqtt_set.calib_bad |= 1 << ch;
+            return;
+        }
+        if (i == 0) {
+            g4_mqtt_set.points[ch][k].adc = strtol(value, NULL, 10);
+        } else {
+            g4_mqtt_set.points[ch][k].percent = strtol(value, NULL, 10);
+        }
+        g4_mqtt_set.calib_filled[ch] |= 1UL << (k * 2 + i);
+        if (k + 1 > g4_mqtt_set.calib_count[ch]) {
+            g4_mqtt_set.calib_count[ch] = k + 1;
+        }
+    }
+}
+
+/**
+  * @brief  处理MQTT接收到的数据，可分段喂入，一条消息跨多个串口帧也能解析
+  * @param  data: 接收到的数据
+  * @param  len: 数据长度
+  * @retval None
+  */
+void G4_ProcessMQTTData(const char* data, uint16_t len)
+{
+    JSON_Feed(&g4_mqtt_parser, data, len);
+}
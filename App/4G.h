@@ -3,17 +3,11 @@
 
 #include "main.h"
 #include "usart.h"
+#include "ring.h"
 
-// 接收缓冲区大小
+// 接收环形缓冲区大小，循环DMA直接写入，必须为2的幂
 #define UART_RX_BUFFER_SIZE 512
 
-// 接收状态
-typedef enum {
-    UART_IDLE,       // 空闲状态
-    UART_RECEIVING,  // 正在接收数据
-    UART_RECEIVED    // 数据接收完成
-} UART_ReceiveState;
-
 // 天气信息结构体
 typedef struct {
     char city[32];      // 城市名称
@@ -29,24 +23,65 @@ typedef enum {
     MQTT_CONNECTED       // 已连接
 } MQTT_State;
 
+// AT命令脚本的一步
+#define G4_AT_OPTIONAL      0x01    // 超时后仍继续下一步
+#define G4_AT_WAIT_LINK     0x02    // 4G连接建立后才发送
+typedef struct {
+    const char *cmd;        // 发送内容，NULL表示不发送
+    const char *expect;     // 响应中应包含的字符串，NULL表示不检查
+    uint16_t timeout_ms;    // 等待响应超时；不检查响应时为发送后的等待时间
+    uint8_t retries;        // 超时后重发次数
+    uint8_t flags;          // G4_AT_OPTIONAL/G4_AT_WAIT_LINK
+    uint8_t (*handler)(const char *data, uint16_t len); // 响应处理，返回1表示已收到期望的响应，可为NULL；
+                                                        // 每次发送前以data=NULL调用一次，用于复位解析状态
+} G4_ATStep_TypeDef;
+
+// AT命令脚本执行阶段
+typedef enum {
+    G4_AT_IDLE,         // 没有脚本在执行
+    G4_AT_LINK,         // 等待4G连接
+    G4_AT_WAIT          // 已发送，等待响应或超时
+} G4_ATPhase_TypeDef;
+
+// 发送队列长度(描述符数)
+#define G4_TX_QUEUE         8
+// 发送缓冲池：需要拼装后异步发送的数据(如上传的JSON)从这里取缓冲区
+#define G4_TX_POOL          2
+#define G4_TX_BUF_SIZE      320
+
+// 发送描述符：只保存指针，不复制数据
+typedef struct {
+    const uint8_t *data;    // 数据，发送完成前必须保持有效
+    uint16_t len;           // 长度
+    void (*done)(const uint8_t *data); // 发送完成回调(中断中调用)，可为NULL
+} G4_TxDesc_TypeDef;
+
+// 等待4G连接的超时时间(ms)
+#define G4_LINK_TIMEOUT_MS  30000
+// MQTT连接失败后的重试间隔(ms)
+#define G4_RETRY_MS         10000
+
 extern Weather_TypeDef g4_weather;
 extern MQTT_State g4_mqtt_state;
 
 // 函数声明
 void G4_Init(void);
-void G4_SendCmd(const char* cmd);
-uint8_t G4_IsDataReceived(void);
+HAL_StatusTypeDef G4_SendCmd(const char* cmd);
+HAL_StatusTypeDef G4_Send(const uint8_t* data, uint16_t len, void (*done)(const uint8_t* data));
+uint8_t* G4_TxAlloc(void);
+uint8_t G4_GetTxDepth(void);
+uint32_t G4_GetTxInFlight(void);
 void G4_ProcessData(void);
+uint8_t G4_IsBusy(void);
 void G4_ClearBuffer(void);
-uint16_t G4_GetDataLength(void);
-uint8_t* G4_GetRxBuffer(void);
+uint32_t G4_GetDroppedBytes(void);
 
 // 添加天气相关函数声明
 HAL_StatusTypeDef G4_GetWeather(void);
-uint8_t G4_ParseWeatherJson(const char* json_data);
+uint8_t G4_ParseWeatherJson(const char* json_data, uint16_t len);
 
 // 添加MQTT相关函数声明
-HAL_StatusTypeDef G4_InitMQTT(uint8_t force_wait);
+HAL_StatusTypeDef G4_InitMQTT(void);
 HAL_StatusTypeDef G4_UploadData(void);
 void G4_ProcessMQTTData(const char* data, uint16_t len);
 
@@ -0,0 +1,300 @@
+#include "calib.h"
+#include "flash.h"
+#include "perf.h"
+
+// 默认标定表，由原分段判断的各档门限得到，0%点按10%~20%段的斜率外推
+static const CALIB_Point_TypeDef calib_default[] = {
+    {220, 0},   {270, 10},  {320, 20},  {380, 30},
+    {430, 40},  {500, 50},  {600, 60},  {830, 70},
+    {1150, 80}, {1800, 90}, {2450, 100}
+};
+
+// 每个水位通道一张标定表
+typedef struct {
+    // 标定点，点数不足CALIB_MAX_POINTS时用最后一点补齐，查找时无需判断边界
+    CALIB_Point_TypeDef table[CALIB_MAX_POINTS];
+    // 各段斜率(Q16格式，百分比/ADC码)，预先计算，查找时不做除法
+    int32_t slope[CALIB_MAX_POINTS];
+    uint8_t count;
+} CALIB_Table_TypeDef;
+
+static CALIB_Table_TypeDef calib[WATER_CHANNELS];
+
+/**
+  * @brief  检查标定表是否有效
+  * @param  points: 标定点数组
+  * @param  count: 点数
+  * @retval 1: 有效，0: 无效
+  * @note   ADC严格递增且百分比不减，保证查表结果单调
+  */
+uint8_t CALIB_Validate(const CALIB_Point_TypeDef *points, uint8_t count)
+{
+    if (count < CALIB_MIN_POINTS || count > CALIB_MAX_POINTS)
+    {
+        return 0;
+    }
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (points[i].adc > 4095 || points[i].percent > 100)
+        {
+            return 0;
+        }
+        if (i > 0 && (points[i].adc <= points[i - 1].adc || points[i].percent < points[i - 1].percent))
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+  * @brief  载入标定表到RAM并预计算斜率
+  * @param  cal: 目标标定表
+  * @param  points: 标定点数组(已校验)
+  * @param  count: 点数
+  * @retval None
+  */
+static void CALIB_Load(CALIB_Table_TypeDef *cal, const CALIB_Point_TypeDef *points, uint8_t count)
+{
+    CALIB_Point_TypeDef *calib_table = cal->table;
+    uint8_t i;
+
+    for (i = 0; i < CALIB_MAX_POINTS; i++)
+    {
+        calib_table[i] = points[(i < count) ? i : count - 1];
+    }
+
+    for (i = 0; i < CALIB_MAX_POINTS - 1; i++)
+    {
+        if (i + 1 < count)
+        {
+            cal->slope[i] = ((int32_t)(calib_table[i + 1].percent - calib_table[i].percent) << 16)
+                           / (calib_table[i + 1].adc - calib_table[i].adc);
+        }
+        else
+        {
+            cal->slope[i] = 0;
+        }
+    }
+    cal->slope[CALIB_MAX_POINTS - 1] = 0;
+
+    cal->count = count;
+}
+
+/**
+  * @brief  从Flash读取标定表
+  * @param  channel: 水位通道
+  * @param  points: 输出数组(至少CALIB_MAX_POINTS个)
+  * @retval 点数，Flash中无有效标定表时返回0
+  */
+static uint8_t CALIB_ReadFlash(uint8_t channel, CALIB_Point_TypeDef *points)
+{
+    uint16_t magic, count;
+    uint32_t address = FLASH_PARAM_CALIB + channel * FLASH_PARAM_CALIB_SIZE;
+
+    FLASH_ReadParam(address, &magic);
+    FLASH_ReadParam(address + 2, &count);
+    if (magic != CALIB_MAGIC || count < CALIB_MIN_POINTS || count > CALIB_MAX_POINTS)
+    {
+        return 0;
+    }
+
+    address += 4;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        FLASH_ReadParam(address, &points[i].adc);
+        FLASH_ReadParam(address + 2, &points[i].percent);
+        address += 4;
+    }
+
+    return CALIB_Validate(points, count) ? count : 0;
+}
+
+/**
+  * @brief  初始化各通道标定表，优先使用Flash中保存的标定表
+  * @retval None
+  */
+void CALIB_Init(void)
+{
+    CALIB_Point_TypeDef points[CALIB_MAX_POINTS];
+
+    for (uint8_t ch = 0; ch < WATER_CHANNELS; ch++)
+    {
+        uint8_t count = CALIB_ReadFlash(ch, points);
+
+        if (count)
+        {
+            CALIB_Load(&calib[ch], points, count);
+        }
+        else
+        {
+            CALIB_Load(&calib[ch], calib_default, sizeof(calib_default) / sizeof(calib_default[0]));
+        }
+    }
+}
+
+/**
+  * @brief  ADC值换算为水位百分比
+  * @param  channel: 水位通道
+  * @param  adc_value: ADC值
+  * @retval 水位百分比(0-100)，1%分辨率
+  */
+uint8_t CALIB_Lookup(uint8_t channel, uint16_t adc_value)
+{
+    return (uint8_t)((CALIB_LookupQ16(channel, adc_value) + 0x8000) >> 16);
+}
+
+/**
+  * @brief  ADC值换算为Q16格式的水位百分比
+  * @param  channel: 水位通道(0~WATER_CHANNELS-1，调用方保证有效)
+  * @param  adc_value: ADC值
+  * @retval 水位百分比(Q16，0-100<<16)
+  * @note   固定4次无分支二分查找 + Q16线性插值，耗时与标定点数无关
+  */
+int32_t CALIB_LookupQ16(uint8_t channel, uint16_t adc_value)
+{
+    const CALIB_Point_TypeDef *calib_table = calib[channel].table;
+    uint8_t base = 0;
+
+    // 低于第一个标定点
+    if (adc_value <= calib_table[0].adc)
+    {
+        return (int32_t)calib_table[0].percent << 16;
+    }
+
+    // 找到最后一个adc <= adc_value的点
+    for (uint8_t half = CALIB_MAX_POINTS / 2; half > 0; half >>= 1)
+    {
+        base += (calib_table[base + half].adc <= adc_value) ? half : 0;
+    }
+
+    return ((int32_t)calib_table[base].percent << 16)
+         + (int32_t)(adc_value - calib_table[base].adc) * calib[channel].slope[base];
+}
+
+/**
+  * @brief  水位百分比反查ADC值
+  * @param  channel: 水位通道
+  * @param  percent: 水位百分比(0-100)
+  * @retval 查表结果不低于percent的最小ADC值，标定表达不到时返回4095
+  * @note   查表结果单调不减，对4096个ADC值二分，固定12次查表
+  */
+uint16_t CALIB_LevelToAdc(uint8_t channel, uint8_t percent)
+{
+    uint16_t low = 0, high = 4095;
+
+    if (CALIB_Lookup(channel, high) < percent)
+    {
+        return high;
+    }
+
+    while (low < high)
+    {
+        uint16_t mid = (low + high) >> 1;
+
+        if (CALIB_Lookup(channel, mid) >= percent)
+        {
+            high = mid;
+        }
+        else
+        {
+            low = mid + 1;
+        }
+    }
+
+    return low;
+}
+
+/**
+  * @brief  设置并保存标定表
+  * @param  channel: 水位通道
+  * @param  points: 标定点数组
+  * @param  count: 点数
+  * @retval HAL状态，通道或标定表无效时返回HAL_ERROR
+  */
+HAL_StatusTypeDef CALIB_SetTable(uint8_t channel, const CALIB_Point_TypeDef *points, uint8_t count)
+{
+    uint16_t buffer[2 + CALIB_MAX_POINTS * 2];
+    HAL_StatusTypeDef status;
+
+    if (channel >= WATER_CHANNELS || !CALIB_Validate(points, count))
+    {
+        return HAL_ERROR;
+    }
+
+    buffer[0] = CALIB_MAGIC;
+    buffer[1] = count;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        buffer[2 + i * 2] = points[i].adc;
+        buffer[3 + i * 2] = points[i].percent;
+    }
+
+    status = FLASH_WriteBlock(FLASH_PARAM_CALIB + channel * FLASH_PARAM_CALIB_SIZE, buffer, 2 + count * 2);
+    if (status == HAL_OK)
+    {
+        CALIB_Load(&calib[channel], points, count);
+    }
+
+    return status;
+}
+
+/**
+  * @brief  获取当前标定表
+  * @param  channel: 水位通道
+  * @param  points: 输出数组
+  * @param  max_count: 输出数组容量
+  * @retval 实际点数，通道无效时返回0
+  */
+uint8_t CALIB_GetTable(uint8_t channel, CALIB_Point_TypeDef *points, uint8_t max_count)
+{
+    uint8_t count;
+
+    if (channel >= WATER_CHANNELS)
+    {
+        return 0;
+    }
+
+    count = (calib[channel].count < max_count) ? calib[channel].count : max_count;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        points[i] = calib[channel].table[i];
+    }
+
+    return count;
+}
+
+#ifdef CALIB_BENCHMARK
+/**
+  * @brief  标定查表自检与基准测试，通过RTT输出
+  * @note   遍历通道0全部4096个ADC值，检查结果单调不减并统计每次查表的周期数
+  * @retval None
+  */
+void CALIB_Benchmark(void)
+{
+    PERF_Stat_TypeDef stat;
+    uint8_t last = 0;
+    uint8_t level;
+    uint32_t start;
+    uint32_t errors = 0;
+
+    PERF_Reset(&stat);
+    for (uint16_t adc = 0; adc < 4096; adc++)
+    {
+        start = PERF_CYCLES();
+        level = CALIB_Lookup(0, adc);
+        PERF_Record(&stat, PERF_CYCLES() - start);
+
+        if (level < last || level > 100)
+        {
+            errors++;
+        }
+        last = level;
+    }
+
+    SEGGER_RTT_printf(0, "calib points=%u monotonic errors=%u\n", calib[0].count, errors);
+    PERF_Print("calib lookup", &stat);
+}
+#endif
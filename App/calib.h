@@ -0,0 +1,32 @@
+#ifndef __CALIB_H
+#define __CALIB_H
+
+#include "main.h"
+
+// 标定表最多点数(二分查找按2的幂展开，必须为2的幂)
+#define CALIB_MAX_POINTS   16
+// 标定表最少点数
+#define CALIB_MIN_POINTS   2
+// Flash中标定表有效标志
+#define CALIB_MAGIC        0xCA1B
+
+// 标定点：ADC值与对应水位百分比
+typedef struct {
+    uint16_t adc;       // ADC值(严格递增)
+    uint16_t percent;   // 水位百分比0-100(不减)
+} CALIB_Point_TypeDef;
+
+// 函数声明
+void CALIB_Init(void);
+uint8_t CALIB_Lookup(uint8_t channel, uint16_t adc_value);
+int32_t CALIB_LookupQ16(uint8_t channel, uint16_t adc_value);
+uint16_t CALIB_LevelToAdc(uint8_t channel, uint8_t percent);
+HAL_StatusTypeDef CALIB_SetTable(uint8_t channel, const CALIB_Point_TypeDef *points, uint8_t count);
+uint8_t CALIB_GetTable(uint8_t channel, CALIB_Point_TypeDef *points, uint8_t max_count);
+uint8_t CALIB_Validate(const CALIB_Point_TypeDef *points, uint8_t count);
+
+#ifdef CALIB_BENCHMARK
+void CALIB_Benchmark(void);
+#endif
+
+#endif /* __CALIB_H */
@@ -0,0 +1,420 @@
+#include "filter.h"
+#include "median.h"
+#include "calib.h"
+#include "flash.h"
+#include <string.h>
+
+// 中位数级的16位暂存区(MEDIAN_Get会打乱数据顺序)
+static uint16_t filter_scratch[FILTER_MAX_BLOCK];
+
+// 各级名称，与FILTER_Type_TypeDef顺序一致
+static const char *filter_names[] = {
+    "median", "window", "iir", "kalman", "calib", "hyst"
+};
+
+/**
+  * @brief  Q16值四舍五入为12位ADC码
+  * @param  x: Q16值
+  * @retval ADC码(0-4095)
+  */
+static uint16_t FILTER_ToAdc(int32_t x)
+{
+    x = FILTER_Q16_INT(x);
+    if (x < 0)
+    {
+        return 0;
+    }
+    return (x > 4095) ? 4095 : (uint16_t)x;
+}
+
+/**
+  * @brief  中位数级：整块求中位数，输出1个样本
+  */
+static uint16_t FILTER_RunMedian(FILTER_Stage_TypeDef *stage, int32_t *data, uint16_t len)
+{
+    (void)stage;
+
+    if (len > FILTER_MAX_BLOCK)
+    {
+        len = FILTER_MAX_BLOCK;
+    }
+    for (uint16_t i = 0; i < len; i++)
+    {
+        filter_scratch[i] = FILTER_ToAdc(data[i]);
+    }
+
+    data[0] = FILTER_Q16(MEDIAN_Get(filter_scratch, len));
+    return 1;
+}
+
+/**
+  * @brief  滑动窗口级：逐样本入窗并输出当前分位数
+  */
+static uint16_t FILTER_RunWindow(FILTER_Stage_TypeDef *stage, int32_t *data, uint16_t len)
+{
+    WINDOW_TypeDef *win = stage->u.window;
+
+    for (uint16_t i = 0; i < len; i++)
+    {
+        WINDOW_Push(win, FILTER_ToAdc(data[i]));
+        data[i] = FILTER_Q16(WINDOW_Get(win));
+    }
+
+    return len;
+}
+
+/**
+  * @brief  IIR级：y += alpha * (x - y)
+  */
+static uint16_t FILTER_RunIIR(FILTER_Stage_TypeDef *stage, int32_t *data, uint16_t len)
+{
+    int32_t y = stage->u.iir.state;
+    int32_t alpha = stage->u.iir.alpha;
+
+    if (!stage->u.iir.primed && len > 0)
+    {
+        // 首个样本直接作为初值，避免从0缓慢爬升
+        y = data[0];
+        stage->u.iir.primed = 1;
+    }
+
+    for (uint16_t i = 0; i < len; i++)
+    {
+        y += (int32_t)(((int64_t)(data[i] - y) * alpha) >> 15);
+        data[i] = y;
+    }
+
+    stage->u.iir.state = y;
+    return len;
+}
+
+/**
+  * @brief  卡尔曼级：一维随机游走模型，每样本一次除法计算增益
+  */
+static uint16_t FILTER_RunKalman(FILTER_Stage_TypeDef *stage, int32_t *data, uint16_t len)
+{
+    int32_t x = stage->u.kalman.x;
+    int32_t p = stage->u.kalman.p;
+    int32_t q = stage->u.kalman.q;
+    int32_t r = stage->u.kalman.r;
+    int32_t k;
+
+    if (!stage->u.kalman.primed && len > 0)
+    {
+        x = data[0];
+        p = r;
+        stage->u.kalman.primed = 1;
+    }
+
+    for (uint16_t i = 0; i < len; i++)
+    {
+        // 预测
+        p += q;
+        // 更新：k = p / (p + r)，Q16
+        k = (int32_t)(((int64_t)p << 16) / (p + r));
+        x += (int32_t)(((int64_t)(data[i] - x) * k) >> 16);
+        p = (int32_t)(((int64_t)(65536 - k) * p) >> 16);
+        data[i] = x;
+    }
+
+    stage->u.kalman.x = x;
+    stage->u.kalman.p = p;
+    return len;
+}
+
+/**
+  * @brief  标定级：ADC值换算为水位百分比(Q16)
+  */
+static uint16_t FILTER_RunCalib(FILTER_Stage_TypeDef *stage, int32_t *data, uint16_t len)
+{
+    uint8_t channel = stage->u.calib.channel;
+
+    for (uint16_t i = 0; i < len; i++)
+    {
+        data[i] = CALIB_LookupQ16(channel, FILTER_ToAdc(data[i]));
+    }
+
+    return len;
+}
+
+/**
+  * @brief  回差量化级：输入偏离当前档超过半个步长加回差才切换到最近的档
+  */
+static uint16_t FILTER_RunHysteresis(FILTER_Stage_TypeDef *stage, int32_t *data, uint16_t len)
+{
+    int32_t out = stage->u.hyst.output;
+    int32_t step = stage->u.hyst.step;
+    int32_t limit = step / 2 + stage->u.hyst.band;
+    int32_t diff;
+
+    if (!stage->u.hyst.primed && len > 0)
+    {
+        out = (data[0] + step / 2) / step * step;
+        stage->u.hyst.primed = 1;
+    }
+
+    for (uint16_t i = 0; i < len; i++)
+    {
+        diff = data[i] - out;
+        if (diff > limit || diff < -limit)
+        {
+            out = (data[i] + step / 2) / step * step;
+        }
+        data[i] = out;
+    }
+
+    stage->u.hyst.output = out;
+    return len;
+}
+
+/**
+  * @brief  追加一级，公共部分初始化
+  * @param  pipe: 流水线指针
+  * @param  type: 级类型
+  * @param  run: 处理函数
+  * @retval 新级指针，流水线已满时返回NULL
+  */
+static FILTER_Stage_TypeDef *FILTER_Add(FILTER_Pipeline_TypeDef *pipe, FILTER_Type_TypeDef type,
+                                        uint16_t (*run)(FILTER_Stage_TypeDef *, int32_t *, uint16_t))
+{
+    FILTER_Stage_TypeDef *stage;
+
+    if (pipe->count >= FILTER_MAX_STAGES)
+    {
+        return NULL;
+    }
+
+    stage = &pipe->stages[pipe->count++];
+    memset(stage, 0, sizeof(FILTER_Stage_TypeDef));
+    stage->type = type;
+    stage->run = run;
+    PERF_Reset(&stage->perf);
+
+    return stage;
+}
+
+/**
+  * @brief  初始化(清空)流水线
+  * @param  pipe: 流水线指针
+  * @retval None
+  */
+void FILTER_Init(FILTER_Pipeline_TypeDef *pipe)
+{
+    memset(pipe, 0, sizeof(FILTER_Pipeline_TypeDef));
+}
+
+/**
+  * @brief  追加中位数级，每块输出一个样本
+  * @param  pipe: 流水线指针
+  * @retval HAL状态
+  */
+HAL_StatusTypeDef FILTER_AddMedian(FILTER_Pipeline_TypeDef *pipe)
+{
+    return FILTER_Add(pipe, FILTER_MEDIAN, FILTER_RunMedian) ? HAL_OK : HAL_ERROR;
+}
+
+/**
+  * @brief  追加滑动窗口分位数级
+  * @param  pipe: 流水线指针
+  * @param  window: 已初始化的窗口(由调用者提供存储，便于另行查询其他分位数)
+  * @retval HAL状态
+  */
+HAL_StatusTypeDef FILTER_AddWindow(FILTER_Pipeline_TypeDef *pipe, WINDOW_TypeDef *window)
+{
+    FILTER_Stage_TypeDef *stage = FILTER_Add(pipe, FILTER_WINDOW, FILTER_RunWindow);
+
+    if (stage == NULL)
+    {
+        return HAL_ERROR;
+    }
+    stage->u.window = window;
+
+    return HAL_OK;
+}
+
+/**
+  * @brief  追加IIR(EMA)低通级
+  * @param  pipe: 流水线指针
+  * @param  alpha_q15: 平滑系数(Q15，1-32768)，时间常数约为1/alpha个样本
+  * @retval HAL状态
+  */
+HAL_StatusTypeDef FILTER_AddIIR(FILTER_Pipeline_TypeDef *pipe, uint16_t alpha_q15)
+{
+    FILTER_Stage_TypeDef *stage;
+
+    if (alpha_q15 == 0 || alpha_q15 > 32768)
+    {
+        return HAL_ERROR;
+    }
+
+    stage = FILTER_Add(pipe, FILTER_IIR, FILTER_RunIIR);
+    if (stage == NULL)
+    {
+        return HAL_ERROR;
+    }
+    stage->u.iir.alpha = alpha_q15;
+
+    return HAL_OK;
+}
+
+/**
+  * @brief  追加一维卡尔曼级
+  * @param  pipe: 流水线指针
+  * @param  q: 过程噪声方差(Q16，单位ADC码^2)
+  * @param  r: 测量噪声方差(Q16，单位ADC码^2)
+  * @retval HAL状态
+  */
+HAL_StatusTypeDef FILTER_AddKalman(FILTER_Pipeline_TypeDef *pipe, int32_t q, int32_t r)
+{
+    FILTER_Stage_TypeDef *stage;
+
+    if (q <= 0 || r <= 0)
+    {
+        return HAL_ERROR;
+    }
+
+    stage = FILTER_Add(pipe, FILTER_KALMAN, FILTER_RunKalman);
+    if (stage == NULL)
+    {
+        return HAL_ERROR;
+    }
+    stage->u.kalman.q = q;
+    stage->u.kalman.r = r;
+
+    return HAL_OK;
+}
+
+/**
+  * @brief  追加标定级，输出水位百分比(Q16)
+  * @param  pipe: 流水线指针
+  * @param  channel: 使用的标定表所属水位通道
+  * @retval HAL状态
+  */
+HAL_StatusTypeDef FILTER_AddCalib(FILTER_Pipeline_TypeDef *pipe, uint8_t channel)
+{
+    FILTER_Stage_TypeDef *stage;
+
+    if (channel >= WATER_CHANNELS)
+    {
+        return HAL_ERROR;
+    }
+
+    stage = FILTER_Add(pipe, FILTER_CALIB, FILTER_RunCalib);
+    if (stage == NULL)
+    {
+        return HAL_ERROR;
+    }
+    stage->u.calib.channel = channel;
+
+    return HAL_OK;
+}
+
+/**
+  * @brief  追加回差量化级
+  * @param  pipe: 流水线指针
+  * @param  step: 量化步长(Q16)
+  * @param  band: 回差(Q16)
+  * @retval HAL状态
+  */
+HAL_StatusTypeDef FILTER_AddHysteresis(FILTER_Pipeline_TypeDef *pipe, int32_t step, int32_t band)
+{
+    FILTER_Stage_TypeDef *stage;
+
+    if (step <= 0 || band < 0)
+    {
+        return HAL_ERROR;
+    }
+
+    stage = FILTER_Add(pipe, FILTER_HYSTERESIS, FILTER_RunHysteresis);
+    if (stage == NULL)
+    {
+        return HAL_ERROR;
+    }
+    stage->u.hyst.step = step;
+    stage->u.hyst.band = band;
+
+    return HAL_OK;
+}
+
+/**
+  * @brief  清除各级内部状态，下一块数据重新初始化
+  * @param  pipe: 流水线指针
+  * @retval None
+  */
+void FILTER_Reset(FILTER_Pipeline_TypeDef *pipe)
+{
+    for (uint8_t i = 0; i < pipe->count; i++)
+    {
+        FILTER_Stage_TypeDef *stage = &pipe->stages[i];
+
+        switch (stage->type)
+        {
+            case FILTER_IIR:
+                stage->u.iir.primed = 0;
+                break;
+            case FILTER_KALMAN:
+                stage->u.kalman.primed = 0;
+                break;
+            case FILTER_HYSTERESIS:
+                stage->u.hyst.primed = 0;
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/**
+  * @brief  一块样本依次通过各级
+  * @param  pipe: 流水线指针
+  * @param  data: Q16样本，原地处理，结果为最后一级输出
+  * @param  len: 样本数
+  * @retval 输出样本数
+  */
+uint16_t FILTER_Run(FILTER_Pipeline_TypeDef *pipe, int32_t *data, uint16_t len)
+{
+    uint32_t start;
+
+    for (uint8_t i = 0; i < pipe->count && len > 0; i++)
+    {
+        FILTER_Stage_TypeDef *stage = &pipe->stages[i];
+
+        start = PERF_CYCLES();
+        stage->samples += len;
+        len = stage->run(stage, data, len);
+        PERF_Record(&stage->perf, PERF_CYCLES() - start);
+        stage->output = data[len - 1];
+    }
+
+    return len;
+}
+
+/**
+  * @brief  获取某一级最近一次输出
+  * @param  pipe: 流水线指针
+  * @param  index: 级序号
+  * @retval Q16值
+  */
+int32_t FILTER_GetOutput(const FILTER_Pipeline_TypeDef *pipe, uint8_t index)
+{
+    return (index < pipe->count) ? pipe->stages[index].output : 0;
+}
+
+/**
+  * @brief  通过RTT输出各级每样本周期数并清零统计
+  * @param  pipe: 流水线指针
+  * @retval None
+  */
+void FILTER_Report(FILTER_Pipeline_TypeDef *pipe)
+{
+    for (uint8_t i = 0; i < pipe->count; i++)
+    {
+        FILTER_Stage_TypeDef *stage = &pipe->stages[i];
+        uint32_t per_sample = stage->samples ? (uint32_t)(stage->perf.total / stage->samples) : 0;
+
+        SEGGER_RTT_printf(0, "filter[%u] %s samples=%u cyc/sample=%u block max=%u\n",
+                          i, filter_names[stage->type], stage->samples, per_sample, stage->perf.max);
+        PERF_Reset(&stage->perf);
+        stage->samples = 0;
+    }
+}
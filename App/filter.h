@@ -0,0 +1,80 @@
+#ifndef __FILTER_H
+#define __FILTER_H
+
+#include "main.h"
+#include "perf.h"
+#include "window.h"
+
+// 流水线最多级数
+#define FILTER_MAX_STAGES   6
+// 单次处理的最大样本数
+#define FILTER_MAX_BLOCK    128
+
+// Q16定点格式，Cortex-M3无FPU，全部滤波运算使用整数完成
+#define FILTER_Q16(x)       ((int32_t)(x) << 16)
+#define FILTER_Q16_INT(x)   (((x) + 0x8000) >> 16)
+
+// 滤波级类型
+typedef enum {
+    FILTER_MEDIAN,      // 块中位数，整块输出一个样本
+    FILTER_WINDOW,      // 滑动窗口分位数，逐样本输出
+    FILTER_IIR,         // 一阶IIR(EMA)低通
+    FILTER_KALMAN,      // 一维卡尔曼滤波(随机游走模型)
+    FILTER_CALIB,       // ADC值经标定表换算为水位百分比
+    FILTER_HYSTERESIS   // 带回差的量化
+} FILTER_Type_TypeDef;
+
+// 滤波级
+typedef struct FILTER_Stage {
+    FILTER_Type_TypeDef type;
+    // 处理一块样本(原地)，返回输出样本数
+    uint16_t (*run)(struct FILTER_Stage *stage, int32_t *data, uint16_t len);
+    PERF_Stat_TypeDef perf;     // 每块耗时
+    uint32_t samples;           // 累计输入样本数，用于计算每样本周期数
+    int32_t output;             // 最近一次输出的最后一个样本(Q16)
+    union {
+        WINDOW_TypeDef *window;
+        struct {
+            uint8_t channel;    // 标定表所属水位通道
+        } calib;
+        struct {
+            int32_t state;      // 输出(Q16)
+            uint16_t alpha;     // 平滑系数(Q15，越小越平滑)
+            uint8_t primed;     // 是否已用首个样本初始化
+        } iir;
+        struct {
+            int32_t x;          // 估计值(Q16)
+            int32_t p;          // 估计方差(Q16)
+            int32_t q;          // 过程噪声方差(Q16)
+            int32_t r;          // 测量噪声方差(Q16)
+            uint8_t primed;
+        } kalman;
+        struct {
+            int32_t output;     // 当前量化输出(Q16)
+            int32_t step;       // 量化步长(Q16)
+            int32_t band;       // 回差(Q16)，超出当前档边界该值才切换
+            uint8_t primed;
+        } hyst;
+    } u;
+} FILTER_Stage_TypeDef;
+
+// 滤波流水线
+typedef struct {
+    FILTER_Stage_TypeDef stages[FILTER_MAX_STAGES];
+    uint8_t count;
+} FILTER_Pipeline_TypeDef;
+
+// 函数声明
+void FILTER_Init(FILTER_Pipeline_TypeDef *pipe);
+HAL_StatusTypeDef FILTER_AddMedian(FILTER_Pipeline_TypeDef *pipe);
+HAL_StatusTypeDef FILTER_AddWindow(FILTER_Pipeline_TypeDef *pipe, WINDOW_TypeDef *window);
+HAL_StatusTypeDef FILTER_AddIIR(FILTER_Pipeline_TypeDef *pipe, uint16_t alpha_q15);
+HAL_StatusTypeDef FILTER_AddKalman(FILTER_Pipeline_TypeDef *pipe, int32_t q, int32_t r);
+HAL_StatusTypeDef FILTER_AddCalib(FILTER_Pipeline_TypeDef *pipe, uint8_t channel);
+HAL_StatusTypeDef FILTER_AddHysteresis(FILTER_Pipeline_TypeDef *pipe, int32_t step, int32_t band);
+void FILTER_Reset(FILTER_Pipeline_TypeDef *pipe);
+uint16_t FILTER_Run(FILTER_Pipeline_TypeDef *pipe, int32_t *data, uint16_t len);
+int32_t FILTER_GetOutput(const FILTER_Pipeline_TypeDef *pipe, uint8_t index);
+void FILTER_Report(FILTER_Pipeline_TypeDef *pipe);
+
+#endif /* __FILTER_H */
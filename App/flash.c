@@ -7,15 +7,18 @@
 HAL_StatusTypeDef FLASH_Init(void)
 {
     uint16_t threshold;
-    HAL_StatusTypeDef status;
-    
-    // 读取水位阈值
-    status = FLASH_ReadParam(FLASH_PARAM_WATER_THRESHOLD, &threshold);
+    HAL_StatusTypeDef status = HAL_OK;
     
-    // 如果读取失败或值无效(0xFFFF表示擦除状态)，则写入默认值
-    if (status != HAL_OK || threshold == 0xFFFF)
+    for (uint8_t ch = 0; ch < WATER_CHANNELS && status == HAL_OK; ch++)
     {
-        status = FLASH_SetWaterThreshold(DEFAULT_WATER_THRESHOLD);
+        // 读取水位阈值
+        status = FLASH_ReadParam(FLASH_PARAM_WATER_THRESHOLD + ch * 2, &threshold);
+        
+        // 如果读取失败或值无效(0xFFFF表示擦除状态)，则写入默认值
+        if (status != HAL_OK || threshold == 0xFFFF)
+        {
+            status = FLASH_SetWaterThreshold(ch, DEFAULT_WATER_THRESHOLD);
+        }
     }
     
     return status;
@@ -41,14 +44,46 @@ HAL_StatusTypeDef FLASH_ReadParam(uint32_t address, uint16_t *data)
   */
 HAL_StatusTypeDef FLASH_WriteParam(uint32_t address, uint16_t data)
 {
+    return FLASH_WriteBlock(address, &data, 1);
+}
+
+/**
+  * @brief  向Flash参数页写入连续多个半字
+  * @param  address: 起始地址(必须位于参数页已使用区域内)
+  * @param  data: 数据指针
+  * @param  count: 半字个数
+  * @retval HAL状态
+  * @note   擦除整页前先把已使用区域读到RAM，改写后整体写回，避免丢失其他参数
+  */
+HAL_StatusTypeDef FLASH_WriteBlock(uint32_t address, const uint16_t *data, uint16_t count)
+{
+    static uint16_t shadow[FLASH_PARAM_USED_SIZE / 2];
     HAL_StatusTypeDef status;
     FLASH_EraseInitTypeDef eraseInit;
     uint32_t pageError = 0;
-    uint16_t currentData;
+    uint16_t offset = (address - FLASH_PARAM_ADDR) / 2;
+    uint16_t i;
+    uint8_t changed = 0;
     
-    // 首先读取当前值，如果相同则不需要写入
-    FLASH_ReadParam(address, &currentData);
-    if (currentData == data)
+    if (address < FLASH_PARAM_ADDR || offset + count > FLASH_PARAM_USED_SIZE / 2)
+    {
+        return HAL_ERROR;
+    }
+    
+    // 读取当前内容，如果相同则不需要写入
+    for (i = 0; i < FLASH_PARAM_USED_SIZE / 2; i++)
+    {
+        FLASH_ReadParam(FLASH_PARAM_ADDR + i * 2, &shadow[i]);
+    }
+    for (i = 0; i < count; i++)
+    {
+        if (shadow[offset + i] != data[i])
+        {
+            shadow[offset + i] = data[i];
+            changed = 1;
+        }
+    }
+    if (!changed)
     {
         return HAL_OK;
     }
@@ -68,8 +103,14 @@ HAL_StatusTypeDef FLASH_WriteParam(uint32_t address, uint16_t data)
         return status;
     }
     
-    // 写入数据
-    status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, address, data);
+    // 写回整个已使用区域(擦除后为0xFFFF的半字无需编程)
+    for (i = 0; i < FLASH_PARAM_USED_SIZE / 2 && status == HAL_OK; i++)
+    {
+        if (shadow[i] != 0xFFFF)
+        {
+            status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, FLASH_PARAM_ADDR + i * 2, shadow[i]);
+        }
+    }
     
     // 锁定Flash
     HAL_FLASH_Lock();
@@ -79,13 +120,15 @@ HAL_StatusTypeDef FLASH_WriteParam(uint32_t address, uint16_t data)
 
 /**
   * @brief  获取水位阈值
+  * @param  channel: 水位通道(0~WATER_CHANNELS-1)
   * @retval 水位阈值(百分比0-100)
   */
-uint16_t FLASH_GetWaterThreshold(void)
+uint16_t FLASH_GetWaterThreshold(uint8_t channel)
 {
     uint16_t threshold;
     
-    if (FLASH_ReadParam(FLASH_PARAM_WATER_THRESHOLD, &threshold) != HAL_OK)
+    if (channel >= WATER_CHANNELS ||
+        FLASH_ReadParam(FLASH_PARAM_WATER_THRESHOLD + channel * 2, &threshold) != HAL_OK)
     {
         // 读取失败，返回默认值
         return DEFAULT_WATER_THRESHOLD;
@@ -102,16 +145,22 @@ uint16_t FLASH_GetWaterThreshold(void)
 
 /**
   * @brief  设置水位阈值
+  * @param  channel: 水位通道(0~WATER_CHANNELS-1)
   * @param  threshold: 水位阈值(百分比0-100)
   * @retval HAL状态
   */
-HAL_StatusTypeDef FLASH_SetWaterThreshold(uint16_t threshold)
+HAL_StatusTypeDef FLASH_SetWaterThreshold(uint8_t channel, uint16_t threshold)
 {
+    if (channel >= WATER_CHANNELS)
+    {
+        return HAL_ERROR;
+    }
+    
     // 验证阈值范围
     if (threshold > 100)
     {
         threshold = 100;
     }
     
-    return FLASH_WriteParam(FLASH_PARAM_WATER_THRESHOLD, threshold);
+    return FLASH_WriteParam(FLASH_PARAM_WATER_THRESHOLD + channel * 2, threshold);
 }
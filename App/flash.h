@@ -5,7 +5,27 @@
 
 // 定义Flash参数存储地址(使用最后一页)
 #define FLASH_PARAM_ADDR      0x0801FC00  // STM32F103C8的Flash最后一页起始地址
-#define FLASH_PARAM_WATER_THRESHOLD  (FLASH_PARAM_ADDR)  // 水位阈值存储地址
+#define FLASH_PARAM_PAGE_SIZE 0x400       // 参数页大小(1KB)
+#define FLASH_PARAM_USED_SIZE 0x120       // 参数页已使用的区域大小，改写时需保留
+#define FLASH_PARAM_WATER_THRESHOLD  (FLASH_PARAM_ADDR)  // 水位阈值存储地址，每通道1个半字
+#define FLASH_PARAM_CALIB     (FLASH_PARAM_ADDR + 0x10)  // 水位标定表存储地址，每通道FLASH_PARAM_CALIB_SIZE
+#define FLASH_PARAM_CALIB_SIZE 0x44                      // 每个标定表占用大小(标志+点数+16个点)
+
+// 参数页最多保存的水位通道数
+#define FLASH_PARAM_CHANNELS  4
+
+// 水位探头通道数，ADC按扫描模式依次转换各通道
+#ifndef WATER_CHANNELS
+#define WATER_CHANNELS 1
+#endif
+
+#if WATER_CHANNELS < 1 || WATER_CHANNELS > FLASH_PARAM_CHANNELS
+#error "WATER_CHANNELS must be between 1 and FLASH_PARAM_CHANNELS"
+#endif
+
+#if FLASH_PARAM_CALIB + FLASH_PARAM_CALIB_SIZE * FLASH_PARAM_CHANNELS > FLASH_PARAM_ADDR + FLASH_PARAM_USED_SIZE
+#error "calibration tables must fit in FLASH_PARAM_USED_SIZE"
+#endif
 
 // 参数默认值
 #define DEFAULT_WATER_THRESHOLD  70  // 默认水位阈值为70%
@@ -14,7 +34,8 @@
 HAL_StatusTypeDef FLASH_Init(void);
 HAL_StatusTypeDef FLASH_ReadParam(uint32_t address, uint16_t *data);
 HAL_StatusTypeDef FLASH_WriteParam(uint32_t address, uint16_t data);
-uint16_t FLASH_GetWaterThreshold(void);
-HAL_StatusTypeDef FLASH_SetWaterThreshold(uint16_t threshold);
+HAL_StatusTypeDef FLASH_WriteBlock(uint32_t address, const uint16_t *data, uint16_t count);
+uint16_t FLASH_GetWaterThreshold(uint8_t channel);
+HAL_StatusTypeDef FLASH_SetWaterThreshold(uint8_t channel, uint16_t threshold);
 
 #endif /* __FLASH_H */
@@ -0,0 +1,115 @@
+#include "font.h"
+
+/**
+  * @brief  解码一个字模
+  * @param  font: 压缩字库
+  * @param  code: 字符(ASCII字库)或字库索引(中文字库)
+  * @param  out: 输出缓冲区，至少width*pages字节，按页存放(与原始字模相同)
+  * @retval 输出字节数，字符不在字库中时返回0
+  * @note   只对非零字节读码字，空白多的字模解码更快
+  */
+uint8_t FONT_Decode(const FONT_TypeDef *font, uint8_t code, uint8_t *out)
+{
+    uint8_t size = font->width * font->pages;
+    uint8_t mask_bytes = (size + 7) / 8;
+    const uint8_t *mask;
+    const uint8_t *p;
+    uint8_t nibble = 0;         // 0:下一个码字在高半字节
+    
+    if (code < font->first || code - font->first >= font->count)
+    {
+        return 0;
+    }
+    
+    mask = font->data + font->index[code - font->first];
+    p = mask + mask_bytes;
+    
+    for (uint8_t i = 0; i < size; i++)
+    {
+        uint8_t c;
+        
+        if (!(mask[i >> 3] & (1 << (i & 7))))
+        {
+            out[i] = 0;
+            continue;
+        }
+        
+        c = nibble ? (*p++ & 0x0F) : (*p >> 4);
+        nibble ^= 1;
+        if (c != FONT_ESCAPE)
+        {
+            out[i] = font->dict[c];
+            continue;
+        }
+        
+        // 转义：原始字节占两个半字节
+        if (nibble)
+        {
+            out[i] = ((*p & 0x0F) << 4) | (p[1] >> 4);
+            p++;
+        }
+        else
+        {
+            out[i] = *p++;
+        }
+    }
+    
+    return size;
+}
+
+/**
+  * @brief  查询字模的显示宽度
+  * @param  font: 压缩字库
+  * @param  code: 字符
+  * @param  left: 输出字模中第一个有效列，可为NULL
+  * @retval 宽度(列)，字符不在字库中时返回0
+  */
+uint8_t FONT_GlyphWidth(const FONT_TypeDef *font, uint8_t code, uint8_t *left)
+{
+    uint8_t m;
+    
+    if (code < font->first || code - font->first >= font->count)
+    {
+        return 0;
+    }
+    
+    if (font->metrics == NULL)
+    {
+        m = font->width; // 等宽字库
+    }
+    else
+    {
+        m = font->metrics[code - font->first];
+    }
+    
+    if (left != NULL)
+    {
+        *left = m >> 4;
+    }
+    return m & 0x0F;
+}
+
+/**
+  * @brief  计算字符串的显示宽度，不解码字模
+  * @param  font: 压缩字库
+  * @param  str: 字符串
+  * @retval 宽度(列)，字符之间含FONT_SPACING列空白，末尾不含
+  * @note   比例字库每个字符只查一次宽度表，O(长度)
+  */
+uint16_t FONT_MeasureText(const FONT_TypeDef *font, const char *str)
+{
+    uint16_t width = 0;
+    uint8_t spacing = (font->metrics != NULL) ? FONT_SPACING : 0;
+    
+    while (*str != '\0')
+    {
+        uint8_t w = FONT_GlyphWidth(font, (uint8_t)*str++, NULL);
+        
+        if (w > 0)
+        {
+            width += w + spacing;
+        }
+    }
+    
+    return (width > 0) ? width - spacing : 0;
+}
@@ -0,0 +1,31 @@
+#ifndef __FONT_H
+#define __FONT_H
+
+#include "main.h"
+
+// 压缩字库中码字的转义值：其后一个字节为原始数据
+#define FONT_ESCAPE         0x0F
+
+// 比例宽度显示时字符之间的空白列数
+#define FONT_SPACING        1
+
+// 压缩字库(由python/gen_font.py从oledfont.h生成)
+// 每个字模：先是非零字节掩码(每字节1位，低位在前)，再是非零字节的4位码字(高半字节在前)，
+// 码字0-14查字典，FONT_ESCAPE后跟2个半字节的原始值
+typedef struct {
+    uint8_t first;              // 第一个字模对应的字符/索引
+    uint8_t count;              // 字模个数
+    uint8_t width;              // 字模宽度(列)
+    uint8_t pages;              // 字模高度(页)
+    const uint8_t *dict;        // 15项字典
+    const uint16_t *index;      // 各字模在data中的起始偏移
+    const uint8_t *data;        // 压缩数据
+    const uint8_t *metrics;     // 各字模(起始列 << 4) | 宽度，NULL表示等宽
+} FONT_TypeDef;
+
+// 函数声明
+uint8_t FONT_Decode(const FONT_TypeDef *font, uint8_t code, uint8_t *out);
+uint8_t FONT_GlyphWidth(const FONT_TypeDef *font, uint8_t code, uint8_t *left);
+uint16_t FONT_MeasureText(const FONT_TypeDef *font, const char *str);
+
+#endif /* __FONT_H */
@@ -0,0 +1,237 @@
+#include "framer.h"
+#include <string.h>
+
+// 分帧模式
+enum {
+    FRAMER_S_LINE = 0,  // 按行
+    FRAMER_S_JSON,      // 行首遇到'{'或'['，到括号配平为止
+    FRAMER_S_PAYLOAD    // 定长负载
+};
+
+/**
+  * @brief  初始化分帧器
+  * @param  f: 分帧器指针
+  * @param  on_line: 未注册前缀的行的处理函数
+  * @param  on_data: JSON和定长负载的处理函数
+  * @param  ctx: 调用者数据，处理函数中通过f->ctx取得
+  * @retval None
+  */
+void FRAMER_Init(FRAMER_TypeDef *f, FRAMER_LineHandler on_line, FRAMER_DataHandler on_data, void *ctx)
+{
+    memset(f, 0, sizeof(FRAMER_TypeDef));
+    f->on_line = on_line;
+    f->on_data = on_data;
+    f->ctx = ctx;
+}
+
+/**
+  * @brief  注册URC前缀
+  * @param  f: 分帧器指针
+  * @param  prefix: 行前缀，如"+QMTRECV:"，必须长期有效
+  * @param  handler: 处理函数，可在其中调用FRAMER_ExpectPayload接收行后的定长负载
+  * @retval HAL_OK 成功，HAL_ERROR 已满
+  */
+HAL_StatusTypeDef FRAMER_Register(FRAMER_TypeDef *f, const char *prefix, FRAMER_LineHandler handler)
+{
+    if (f->urc_count >= FRAMER_URC_MAX)
+    {
+        return HAL_ERROR;
+    }
+
+    f->urc[f->urc_count].prefix = prefix;
+    f->urc[f->urc_count].prefix_len = strlen(prefix);
+    f->urc[f->urc_count].handler = handler;
+    f->urc_count++;
+    return HAL_OK;
+}
+
+/**
+  * @brief  丢弃半行和未完成的负载
+  * @param  f: 分帧器指针
+  * @retval None
+  * @note   在处理函数中调用时，FRAMER_Feed处理完当前字节即返回，剩余数据由调用者决定是否丢弃
+  */
+void FRAMER_Reset(FRAMER_TypeDef *f)
+{
+    if (f->state != FRAMER_S_LINE)
+    {
+        f->on_data(f, NULL, 0, FRAMER_ABORT);
+    }
+    f->state = FRAMER_S_LINE;
+    f->line_len = 0;
+    f->stop = 1;
+}
+
+/**
+  * @brief  当前行之后的len字节作为定长负载交给on_data
+  * @param  f: 分帧器指针
+  * @param  len: 负载长度
+  * @retval None
+  * @note   只在行处理函数中调用
+  */
+void FRAMER_ExpectPayload(FRAMER_TypeDef *f, uint16_t len)
+{
+    if (len)
+    {
+        f->state = FRAMER_S_PAYLOAD;
+        f->remain = len;
+    }
+}
+
+/**
+  * @brief  一行结束，按前缀分发
+  * @param  f: 分帧器指针
+  * @retval None
+  */
+static void FRAMER_EndLine(FRAMER_TypeDef *f)
+{
+    uint16_t len = f->line_len;
+
+    f->line_len = 0;
+    if (len == 0)
+    {
+        return;
+    }
+    f->line[len] = '\0';
+
+    for (uint8_t i = 0; i < f->urc_count; i++)
+    {
+        if (len >= f->urc[i].prefix_len && memcmp(f->line, f->urc[i].prefix, f->urc[i].prefix_len) == 0)
+        {
+            f->urc[i].handler(f, f->line, len);
+            return;
+        }
+    }
+    f->on_line(f, f->line, len);
+}
+
+/**
+  * @brief  喂入一段数据
+  * @param  f: 分帧器指针
+  * @param  data: 数据，可以是任意片段
+  * @param  len: 长度
+  * @param  now: 当前时刻(ms)
+  * @retval 已处理的字节数，处理函数中调用FRAMER_Reset时小于len
+  * @note   行复制到行缓冲区；JSON和定长负载按连续片段直接交给on_data，不复制
+  */
+uint16_t FRAMER_Feed(FRAMER_TypeDef *f, const uint8_t *data, uint16_t len, uint32_t now)
+{
+    uint16_t start = 0;     // 本次调用中JSON片段的起点
+
+    f->stop = 0;
+    if (len)
+    {
+        f->last_tick = now;
+    }
+
+    for (uint16_t i = 0; i < len; i++)
+    {
+        char c = data[i];
+
+        if (f->state == FRAMER_S_LINE)
+        {
+            if (c == '\n')
+            {
+                FRAMER_EndLine(f);
+            }
+            else if (c == '\r')
+            {
+                // 行尾CR忽略，只按LF断行
+            }
+            else if (f->line_len == 0 && (c == '{' || c == '['))
+            {
+                f->state = FRAMER_S_JSON;
+                f->depth = 1;
+                f->in_string = 0;
+                f->escape = 0;
+                start = i;
+            }
+            else if (f->line_len < FRAMER_LINE_MAX)
+            {
+                f->line[f->line_len++] = c;
+            }
+        }
+        else if (f->state == FRAMER_S_JSON)
+        {
+            // 只跟踪字符串和括号层数，内容交给on_data解析
+            if (f->escape)
+            {
+                f->escape = 0;
+            }
+            else if (f->in_string)
+            {
+                if (c == '\\')
+                {
+                    f->escape = 1;
+                }
+                else if (c == '"')
+                {
+                    f->in_string = 0;
+                }
+            }
+            else if (c == '"')
+            {
+                f->in_string = 1;
+            }
+            else if (c == '{' || c == '[')
+            {
+                f->depth++;
+            }
+            else if ((c == '}' || c == ']') && --f->depth == 0)
+            {
+                f->state = FRAMER_S_LINE;
+                f->on_data(f, data + start, i + 1 - start, FRAMER_DONE);
+            }
+        }
+        else
+        {
+            // 定长负载整段交出
+            uint16_t n = (len - i < f->remain) ? len - i : f->remain;
+            f->remain -= n;
+            if (f->remain == 0)
+            {
+                f->state = FRAMER_S_LINE;
+            }
+            f->on_data(f, data + i, n, f->remain ? FRAMER_MORE : FRAMER_DONE);
+            i += n - 1;
+        }
+
+        if (f->stop)
+        {
+            f->stop = 0;
+            return i + 1;
+        }
+    }
+
+    // JSON未结束，本段先交出
+    if (f->state == FRAMER_S_JSON && start < len)
+    {
+        f->on_data(f, data + start, len - start, FRAMER_MORE);
+    }
+    return len;
+}
+
+/**
+  * @brief  检查超时，在主循环中调用
+  * @param  f: 分帧器指针
+  * @param  now: 当前时刻(ms)
+  * @retval None
+  * @note   没有行尾的半行(如"> "提示符)超时后按一行分发；JSON和定长负载超时后中止
+  */
+void FRAMER_Poll(FRAMER_TypeDef *f, uint32_t now)
+{
+    if (now - f->last_tick < FRAMER_TIMEOUT_MS)
+    {
+        return;
+    }
+
+    if (f->state != FRAMER_S_LINE)
+    {
+        f->state = FRAMER_S_LINE;
+        f->on_data(f, NULL, 0, FRAMER_ABORT);
+    }
+    else if (f->line_len)
+    {
+        FRAMER_EndLine(f);
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef __FRAMER_H
+#define __FRAMER_H
+
+#include "main.h"
+
+// 一行最大长度，超出部分截断
+#define FRAMER_LINE_MAX     128
+// 可注册的URC前缀数
+#define FRAMER_URC_MAX      4
+// 半行、JSON或定长负载超过此时间(ms)没有新字节即结束：半行按一行处理(如"> "提示符)，负载按中止处理
+#define FRAMER_TIMEOUT_MS   500
+
+// 负载片段状态
+typedef enum {
+    FRAMER_MORE = 0,    // 后面还有
+    FRAMER_DONE,        // 负载结束
+    FRAMER_ABORT        // 超时或被复位，之前的片段作废
+} FRAMER_End;
+
+typedef struct FRAMER FRAMER_TypeDef;
+
+// 行处理：line以0结尾，不含行尾
+typedef void (*FRAMER_LineHandler)(FRAMER_TypeDef *f, const char *line, uint16_t len);
+// 负载处理：data直接指向输入数据，不复制；FRAMER_ABORT时data为NULL
+typedef void (*FRAMER_DataHandler)(FRAMER_TypeDef *f, const uint8_t *data, uint16_t len, FRAMER_End end);
+
+// URC(主动上报)：以prefix开头的行交给handler
+typedef struct {
+    const char *prefix;
+    uint8_t prefix_len;
+    FRAMER_LineHandler handler;
+} FRAMER_Urc_TypeDef;
+
+// 模块数据流分帧器：把字节流切成响应行、URC行、透传JSON和定长负载，每字节O(1)
+struct FRAMER {
+    FRAMER_LineHandler on_line;     // 其他行(OK/ERROR/命令响应)
+    FRAMER_DataHandler on_data;     // 透传JSON和定长负载
+    void *ctx;                      // 调用者数据
+    FRAMER_Urc_TypeDef urc[FRAMER_URC_MAX];
+    uint8_t urc_count;
+    uint8_t state;                  // 当前模式
+    uint8_t stop;                   // 处理函数中复位，FRAMER_Feed立即返回
+    uint8_t depth;                  // JSON嵌套层数
+    uint8_t in_string;              // JSON字符串内
+    uint8_t escape;                 // JSON字符串内'\'之后
+    uint16_t remain;                // 定长负载剩余字节数
+    uint16_t line_len;
+    uint32_t last_tick;             // 最近收到字节的时刻(ms)
+    char line[FRAMER_LINE_MAX + 1];
+};
+
+// 函数声明
+void FRAMER_Init(FRAMER_TypeDef *f, FRAMER_LineHandler on_line, FRAMER_DataHandler on_data, void *ctx);
+HAL_StatusTypeDef FRAMER_Register(FRAMER_TypeDef *f, const char *prefix, FRAMER_LineHandler handler);
+void FRAMER_Reset(FRAMER_TypeDef *f);
+void FRAMER_ExpectPayload(FRAMER_TypeDef *f, uint16_t len);
+uint16_t FRAMER_Feed(FRAMER_TypeDef *f, const uint8_t *data, uint16_t len, uint32_t now);
+void FRAMER_Poll(FRAMER_TypeDef *f, uint32_t now);
+
+#endif /* __FRAMER_H */
@@ -0,0 +1,106 @@
+#include "history.h"
+#include <string.h>
+
+/**
+  * @brief  初始化水位历史
+  * @param  h: 历史指针
+  * @param  bucket_ms: 每桶时长(ms)
+  * @param  now: 当前时刻(ms)，作为第一个桶的开始
+  * @retval None
+  */
+void HISTORY_Init(HISTORY_TypeDef *h, uint32_t bucket_ms, uint32_t now)
+{
+    memset(h, 0, sizeof(HISTORY_TypeDef));
+    h->bucket_ms = bucket_ms;
+    h->bucket_start = now;
+}
+
+/**
+  * @brief  结束当前桶并写入环形缓冲区，无样本的桶用最近一个样本填充
+  * @param  h: 历史指针
+  * @retval None
+  */
+static void HISTORY_Close(HISTORY_TypeDef *h)
+{
+    if (!h->cur_valid)
+    {
+        h->cur_min = h->last;
+        h->cur_max = h->last;
+    }
+    
+    h->min[h->head] = h->cur_min;
+    h->max[h->head] = h->cur_max;
+    h->head = (h->head + 1) % HISTORY_DEPTH;
+    if (h->count < HISTORY_DEPTH)
+    {
+        h->count++;
+    }
+    h->total++;
+    h->cur_valid = 0;
+}
+
+/**
+  * @brief  加入一个水位样本，跨过桶边界时先结束已满的桶
+  * @param  h: 历史指针
+  * @param  now: 样本时刻(ms)
+  * @param  level: 水位(%)
+  * @retval 本次结束的桶数，通常为0或1；长时间未调用时为跨过的桶数(最多HISTORY_DEPTH)
+  */
+uint16_t HISTORY_Add(HISTORY_TypeDef *h, uint32_t now, uint8_t level)
+{
+    uint16_t closed = 0;
+    
+    while ((now - h->bucket_start) >= h->bucket_ms)
+    {
+        HISTORY_Close(h);
+        h->bucket_start += h->bucket_ms;
+        
+        // 间隔超过整个窗口时后面的桶都是同一个值，不必逐个补齐
+        if (++closed >= HISTORY_DEPTH)
+        {
+            h->bucket_start = now;
+            break;
+        }
+    }
+    
+    if (!h->cur_valid)
+    {
+        h->cur_min = level;
+        h->cur_max = level;
+        h->cur_valid = 1;
+    }
+    else if (level < h->cur_min)
+    {
+        h->cur_min = level;
+    }
+    else if (level > h->cur_max)
+    {
+        h->cur_max = level;
+    }
+    h->last = level;
+    
+    return closed;
+}
+
+/**
+  * @brief  读取一个已结束的桶
+  * @param  h: 历史指针
+  * @param  age: 0为最近结束的桶，越大越旧
+  * @param  min: 输出最小值
+  * @param  max: 输出最大值
+  * @retval 1:成功 0:该桶还没有数据
+  */
+uint8_t HISTORY_Get(const HISTORY_TypeDef *h, uint16_t age, uint8_t *min, uint8_t *max)
+{
+    uint16_t index;
+    
+    if (age >= h->count)
+    {
+        return 0;
+    }
+    
+    index = (h->head + HISTORY_DEPTH - 1 - age) % HISTORY_DEPTH;
+    *min = h->min[index];
+    *max = h->max[index];
+    return 1;
+}
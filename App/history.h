@@ -0,0 +1,31 @@
+#ifndef __HISTORY_H
+#define __HISTORY_H
+
+#include "main.h"
+
+// 历史桶数，与历史曲线宽度(列)相同
+#define HISTORY_SIZE        120
+// 多存一个桶，曲线最左列也能与更早的桶相接
+#define HISTORY_DEPTH       (HISTORY_SIZE + 1)
+
+// 水位历史：按固定时长分桶，每桶只保存最小值和最大值
+typedef struct {
+    uint8_t min[HISTORY_DEPTH]; // 各桶最小水位(%)，环形存放
+    uint8_t max[HISTORY_DEPTH]; // 各桶最大水位(%)
+    uint16_t head;              // 下一个写入位置
+    uint16_t count;             // 已保存的桶数
+    uint32_t total;             // 累计结束的桶数，用于判断自上次绘制以来新增了几个桶
+    uint32_t bucket_ms;         // 每桶时长(ms)
+    uint32_t bucket_start;      // 当前桶开始时刻(ms)
+    uint8_t cur_min;            // 当前桶的最小值
+    uint8_t cur_max;            // 当前桶的最大值
+    uint8_t cur_valid;          // 当前桶是否已有样本
+    uint8_t last;               // 最近一个样本，空桶以此填充
+} HISTORY_TypeDef;
+
+// 函数声明
+void HISTORY_Init(HISTORY_TypeDef *h, uint32_t bucket_ms, uint32_t now);
+uint16_t HISTORY_Add(HISTORY_TypeDef *h, uint32_t now, uint8_t level);
+uint8_t HISTORY_Get(const HISTORY_TypeDef *h, uint16_t age, uint8_t *min, uint8_t *max);
+
+#endif /* __HISTORY_H */
@@ -0,0 +1,585 @@
+#include "json.h"
+#include <string.h>
+
+// 词法状态
+enum {
+    JSON_S_IDLE = 0,    // 文档外，等待'{'或'['
+    JSON_S_VALUE,       // 等待值
+    JSON_S_VALUE_FIRST, // 数组刚打开，等待值或']'
+    JSON_S_KEY,         // 对象刚打开，等待键名或'}'
+    JSON_S_KEY_NEXT,    // ','之后，等待键名
+    JSON_S_COLON,       // 等待':'
+    JSON_S_AFTER,       // 值结束，等待','或容器结束
+    JSON_S_STRING,      // 字符串内
+    JSON_S_ESCAPE,      // 字符串内'\'之后
+    JSON_S_LITERAL      // 数字/true/false/null
+};
+
+/**
+  * @brief  初始化解析器
+  * @param  p: 解析器指针
+  * @param  callback: 事件回调
+  * @param  ctx: 调用者数据，回调中通过p->ctx取得
+  * @retval None
+  */
+void JSON_Init(JSON_ParserTypeDef *p, JSON_Callback callback, void *ctx)
+{
+    memset(p, 0, sizeof(JSON_ParserTypeDef));
+    p->callback = callback;
+    p->ctx = ctx;
+}
+
+/**
+  * @brief  丢弃解析到一半的文档，等待下一个'{'或'['
+  * @param  p: 解析器指针
+  * @retval None
+  */
+void JSON_Reset(JSON_ParserTypeDef *p)
+{
+    p->state = JSON_S_IDLE;
+    p->depth = 0;
+    p->path_len = 0;
+    p->unicode = 0;
+}
+
+/**
+  * @brief  通知回调
+  * @param  p: 解析器指针
+  * @param  type: 事件类型
+  * @retval None
+  */
+static void JSON_Emit(JSON_ParserTypeDef *p, JSON_Type type)
+{
+    p->path[p->path_len] = '\0';
+    p->value[p->value_len] = '\0';
+    p->callback(p, type, p->value, p->value_len);
+}
+
+/**
+  * @brief  语法错误：丢弃当前文档
+  * @param  p: 解析器指针
+  * @retval None
+  */
+static void JSON_Error(JSON_ParserTypeDef *p)
+{
+    JSON_Reset(p);
+    p->value_len = 0;
+    JSON_Emit(p, JSON_ERROR);
+}
+
+/**
+  * @brief  路径追加一个字符，超长时以'~'结尾
+  * @param  p: 解析器指针
+  * @param  c: 字符
+  * @retval None
+  */
+static void JSON_PathPut(JSON_ParserTypeDef *p, char c)
+{
+    if (p->path_len < JSON_PATH_MAX)
+    {
+        p->path[p->path_len++] = c;
+    }
+    else
+    {
+        p->path[JSON_PATH_MAX - 1] = '~';
+    }
+}
+
+/**
+  * @brief  值追加一个字符，超长截断
+  * @param  p: 解析器指针
+  * @param  c: 字符
+  * @retval None
+  */
+static void JSON_ValuePut(JSON_ParserTypeDef *p, char c)
+{
+    if (p->value_len < JSON_VALUE_MAX)
+    {
+        p->value[p->value_len++] = c;
+    }
+}
+
+/**
+  * @brief  打开一层对象或数组
+  * @param  p: 解析器指针
+  * @param  is_array: 1数组，0对象
+  * @retval None
+  */
+static void JSON_Open(JSON_ParserTypeDef *p, uint8_t is_array)
+{
+    if (p->depth >= JSON_MAX_DEPTH)
+    {
+        JSON_Error(p);
+        return;
+    }
+
+    p->base[p->depth] = p->path_len;
+    p->index[p->depth] = 0;
+    if (is_array)
+    {
+        p->array |= 1 << p->depth;
+    }
+    else
+    {
+        p->array &= ~(1 << p->depth);
+    }
+    p->depth++;
+    p->state = is_array ? JSON_S_VALUE_FIRST : JSON_S_KEY;
+}
+
+/**
+  * @brief  关闭一层对象或数组，顶层关闭时文档结束
+  * @param  p: 解析器指针
+  * @param  is_array: 1遇到']'，0遇到'}'
+  * @retval None
+  */
+static void JSON_Close(JSON_ParserTypeDef *p, uint8_t is_array)
+{
+    if (p->depth == 0 || ((p->array >> (p->depth - 1)) & 1) != is_array)
+    {
+        JSON_Error(p);
+        return;
+    }
+
+    p->depth--;
+    p->path_len = p->base[p->depth];
+    if (p->depth == 0)
+    {
+        p->state = JSON_S_IDLE;
+        p->value_len = 0;
+        JSON_Emit(p, JSON_END);
+    }
+    else
+    {
+        p->state = JSON_S_AFTER;
+    }
+}
+
+/**
+  * @brief  非字符串标量结束，校验true/false/null并通知回调
+  * @param  p: 解析器指针
+  * @retval None
+  */
+static void JSON_EndLiteral(JSON_ParserTypeDef *p)
+{
+    static const char *const words[] = {"true", "false", "null"};
+
+    p->value[p->value_len] = '\0';
+    if (p->literal != JSON_NUMBER && strcmp(p->value, words[p->literal - JSON_TRUE]) != 0)
+    {
+        JSON_Error(p);
+        return;
+    }
+    JSON_Emit(p, (JSON_Type)p->literal);
+    p->state = JSON_S_AFTER;
+}
+
+/**
+  * @brief  是否为空白字符
+  * @param  c: 字符
+  * @retval 1是，0否
+  */
+static uint8_t JSON_IsSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/**
+  * @brief  是否为十六进制数字
+  * @param  c: 字符
+  * @retval 1是，0否
+  */
+static uint8_t JSON_IsHex(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+/**
+  * @brief  开始解析一个值
+  * @param  p: 解析器指针
+  * @param  c: 值的第一个字符
+  * @retval None
+  */
+static void JSON_BeginValue(JSON_ParserTypeDef *p, char c)
+{
+    p->value_len = 0;
+    if (c == '{' || c == '[')
+    {
+        JSON_Open(p, c == '[');
+    }
+    else if (c == '"')
+    {
+        p->is_key = 0;
+        p->state = JSON_S_STRING;
+    }
+    else if (c == '-' || (c >= '0' && c <= '9'))
+    {
+        p->literal = JSON_NUMBER;
+        JSON_ValuePut(p, c);
+        p->state = JSON_S_LITERAL;
+    }
+    else if (c == 't' || c == 'f' || c == 'n')
+    {
+        p->literal = (c == 't') ? JSON_TRUE : (c == 'f') ? JSON_FALSE : JSON_NULL;
+        JSON_ValuePut(p, c);
+        p->state = JSON_S_LITERAL;
+    }
+    else
+    {
+        JSON_Error(p);
+    }
+}
+
+/**
+  * @brief  喂入一段数据
+  * @param  p: 解析器指针
+  * @param  data: 数据，可以是文档的任意片段，不要求以0结尾
+  * @param  len: 长度
+  * @retval None
+  * @note   每解析出一个标量值回调一次(携带完整路径)，文档结束回调JSON_END；
+  *         文档外的字节(如模块附加的前缀)直接跳过
+  */
+void JSON_Feed(JSON_ParserTypeDef *p, const char *data, uint16_t len)
+{
+    for (uint16_t i = 0; i < len; i++)
+    {
+        char c = data[i];
+
+        if (p->state == JSON_S_LITERAL)
+        {
+            if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                c == '.' || c == '+' || c == '-')
+            {
+                JSON_ValuePut(p, c);
+                continue;
+            }
+            // 标量结束，当前字符继续按值之后处理
+            JSON_EndLiteral(p);
+        }
+
+        switch (p->state)
+        {
+        case JSON_S_IDLE:
+            if (c == '{' || c == '[')
+            {
+                p->path_len = 0;
+                JSON_Open(p, c == '[');
+            }
+            break;
+
+        case JSON_S_STRING:
+            if (p->unicode)
+            {
+                // \uXXXX的十六进制位，整体以'?'代替
+                if (!JSON_IsHex(c))
+                {
+                    JSON_Error(p);
+                    break;
+                }
+                p->unicode--;
+            }
+            else if (c == '"')
+            {
+                if (p->is_key)
+                {
+                    p->state = JSON_S_COLON;
+                }
+                else
+                {
+                    JSON_Emit(p, JSON_STRING);
+                    p->state = JSON_S_AFTER;
+                }
+            }
+            else if (c == '\\')
+            {
+                p->state = JSON_S_ESCAPE;
+            }
+            else
+            {
+                // 普通字符连续处理，到引号或转义符为止
+                uint16_t end = i + 1;
+                while (end < len && data[end] != '"' && data[end] != '\\')
+                {
+                    end++;
+                }
+                for (; i < end; i++)
+                {
+                    if (p->is_key)
+                    {
+                        JSON_PathPut(p, data[i]);
+                    }
+                    else
+                    {
+                        JSON_ValuePut(p, data[i]);
+                    }
+                }
+                i--;
+            }
+            break;
+
+        case JSON_S_ESCAPE:
+            p->state = JSON_S_STRING;
+            switch (c)
+            {
+            case '"':
+            case '\\':
+            case '/':
+                break;
+            case 'b':
+                c = '\b';
+                break;
+            case 'f':
+                c = '\f';
+                break;
+            case 'n':
+                c = '\n';
+                break;
+            case 'r':
+                c = '\r';
+                break;
+            case 't':
+                c = '\t';
+                break;
+            case 'u':
+                p->unicode = 4;
+                c = '?';
+                break;
+            default:
+                // RFC 8259之外的转义
+                JSON_Error(p);
+                continue;
+            }
+            if (p->is_key)
+            {
+                JSON_PathPut(p, c);
+            }
+            else
+            {
+                JSON_ValuePut(p, c);
+            }
+            break;
+
+        default:
+            if (JSON_IsSpace(c))
+            {
+                break;
+            }
+            if (p->state == JSON_S_VALUE || p->state == JSON_S_VALUE_FIRST)
+            {
+                if (c == ']' && p->state == JSON_S_VALUE_FIRST)
+                {
+                    JSON_Close(p, 1);
+                }
+                else
+                {
+                    JSON_BeginValue(p, c);
+                }
+            }
+            else if (p->state == JSON_S_KEY || p->state == JSON_S_KEY_NEXT)
+            {
+                if (c == '"')
+                {
+                    // 键名直接写入路径：容器路径 + '.' + 键名
+                    p->path_len = p->base[p->depth - 1];
+                    if (p->path_len)
+                    {
+                        JSON_PathPut(p, '.');
+                    }
+                    p->is_key = 1;
+                    p->state = JSON_S_STRING;
+                }
+                else if (c == '}' && p->state == JSON_S_KEY)
+                {
+                    JSON_Close(p, 0);
+                }
+                else
+                {
+                    JSON_Error(p);
+                }
+            }
+            else if (p->state == JSON_S_COLON)
+            {
+                if (c == ':')
+                {
+                    p->state = JSON_S_VALUE;
+                }
+                else
+                {
+                    JSON_Error(p);
+                }
+            }
+            else if (p->state == JSON_S_AFTER)
+            {
+                if (c == ',')
+                {
+                    if ((p->array >> (p->depth - 1)) & 1)
+                    {
+                        p->index[p->depth - 1]++;
+                        p->path_len = p->base[p->depth - 1];
+                        p->state = JSON_S_VALUE;
+                    }
+                    else
+                    {
+                        p->state = JSON_S_KEY_NEXT;
+                    }
+                }
+                else if (c == '}' || c == ']')
+                {
+                    JSON_Close(p, c == ']');
+                }
+                else
+                {
+                    JSON_Error(p);
+                }
+            }
+            break;
+        }
+    }
+}
+
+/**
+  * @brief  当前值的路径是否等于path
+  * @param  p: 解析器指针
+  * @param  path: 路径，如"results.now.text"
+  * @retval 1是，0否
+  * @note   只在事件回调中有效
+  */
+uint8_t JSON_PathIs(const JSON_ParserTypeDef *p, const char *path)
+{
+    return strcmp(p->path, path) == 0;
+}
+
+/**
+  * @brief  当前值所在数组的元素序号
+  * @param  p: 解析器指针
+  * @param  up: 0为最内层容器，1为外面一层，依此类推
+  * @retval 元素序号(0起)，该层不是数组时为0
+  * @note   只在事件回调中有效
+  */
+uint16_t JSON_Index(const JSON_ParserTypeDef *p, uint8_t up)
+{
+    if (up >= p->depth)
+    {
+        return 0;
+    }
+    return p->index[p->depth - 1 - up];
+}
+
+#ifdef JSON_BENCHMARK
+#include "perf.h"
+#include <stdio.h>
+
+#define JSON_BENCH_ROUNDS   100
+#define JSON_BENCH_CHUNK    16
+
+// 心知天气now接口的典型响应
+static const char bench_weather[] =
+    "{\"results\":[{\"location\":{\"id\":\"WKJYKT0UM6QC\",\"name\":\"Guilin\",\"country\":\"CN\","
+    "\"path\":\"Guilin,Guilin,Guangxi,China\",\"timezone\":\"Asia/Shanghai\",\"timezone_offset\":\"+08:00\"},"
+    "\"now\":{\"text\":\"Cloudy\",\"code\":\"4\",\"temperature\":\"26\"},"
+    "\"last_update\":\"2025-05-20T10:30:00+08:00\"}]}";
+
+static char bench_field[3][32];
+
+/**
+  * @brief  原方法：每个字段一次strstr全文扫描，再逐字节复制到引号为止
+  * @param  json: 以0结尾的JSON文本
+  * @retval 提取到的字段数
+  */
+static uint8_t JSON_BenchStrstr(const char *json)
+{
+    static const char *const keys[] = {"\"name\":\"", "\"text\":\"", "\"temperature\":\""};
+    uint8_t found = 0;
+
+    for (uint8_t k = 0; k < 3; k++)
+    {
+        const char *pos = strstr(json, keys[k]);
+        if (pos)
+        {
+            uint8_t i = 0;
+            pos += strlen(keys[k]);
+            while (*pos != '"' && i < sizeof(bench_field[k]) - 1)
+            {
+                bench_field[k][i++] = *pos++;
+            }
+            bench_field[k][i] = '\0';
+            found++;
+        }
+    }
+    return found;
+}
+
+/**
+  * @brief  基准测试回调：按路径取三个字段
+  * @retval None
+  */
+static void JSON_BenchCallback(JSON_ParserTypeDef *p, JSON_Type type, const char *value, uint8_t len)
+{
+    static const char *const paths[] = {"results.location.name", "results.now.text", "results.now.temperature"};
+    uint8_t *found = (uint8_t *)p->ctx;
+
+    if (type != JSON_STRING)
+    {
+        return;
+    }
+    for (uint8_t k = 0; k < 3; k++)
+    {
+        if (JSON_PathIs(p, paths[k]))
+        {
+            memcpy(bench_field[k], value, len + 1);
+            (*found)++;
+        }
+    }
+}
+
+/**
+  * @brief  天气JSON字段提取基准测试，通过RTT输出
+  * @note   strstr: 原来的逐字段全文扫描；stream: 流式解析整段一次喂入；
+  *         chunk16: 每次喂入16字节，模拟跨多个串口空闲帧到达
+  * @retval None
+  */
+void JSON_Benchmark(void)
+{
+    static const char *names[] = {"strstr", "stream", "chunk16"};
+    JSON_ParserTypeDef parser;
+    PERF_Stat_TypeDef stat;
+    uint16_t len = sizeof(bench_weather) - 1;
+    uint8_t found = 0;
+    uint32_t start;
+    char label[sizeof(bench_field) + 64];
+
+    PERF_Init();
+    JSON_Init(&parser, JSON_BenchCallback, &found);
+
+    for (uint8_t m = 0; m < 3; m++)
+    {
+        PERF_Reset(&stat);
+        for (uint8_t r = 0; r < JSON_BENCH_ROUNDS; r++)
+        {
+            found = 0;
+            start = PERF_CYCLES();
+            if (m == 0)
+            {
+                found = JSON_BenchStrstr(bench_weather);
+            }
+            else if (m == 1)
+            {
+                JSON_Feed(&parser, bench_weather, len);
+            }
+            else
+            {
+                for (uint16_t off = 0; off < len; off += JSON_BENCH_CHUNK)
+                {
+                    JSON_Feed(&parser, bench_weather + off, (len - off < JSON_BENCH_CHUNK) ? len - off : JSON_BENCH_CHUNK);
+                }
+            }
+            PERF_Record(&stat, PERF_CYCLES() - start);
+        }
+
+        sprintf(label, "json %s %u bytes fields=%u %s/%s/%s %lu bytes/ms", names[m], len, found,
+                bench_field[0], bench_field[1], bench_field[2],
+                (unsigned long)((uint64_t)len * (SystemCoreClock / 1000) / PERF_Average(&stat)));
+        PERF_Print(label, &stat);
+    }
+}
+#endif
@@ -0,0 +1,57 @@
+#ifndef __JSON_H
+#define __JSON_H
+
+#include "main.h"
+
+// 最大嵌套层数
+#define JSON_MAX_DEPTH      8
+// 路径最大长度(各层键名以'.'连接，数组层不占路径)，超长的路径以'~'结尾，不会与短路径混淆
+#define JSON_PATH_MAX       48
+// 标量值最大长度，超出部分截断
+#define JSON_VALUE_MAX      32
+
+// 事件类型
+typedef enum {
+    JSON_STRING,        // 字符串值(已去掉引号和转义)
+    JSON_NUMBER,        // 数字，原样文本
+    JSON_TRUE,
+    JSON_FALSE,
+    JSON_NULL,
+    JSON_END,           // 一个完整的顶层对象/数组结束
+    JSON_ERROR          // 语法错误，已丢弃当前文档，等待下一个'{'或'['
+} JSON_Type;
+
+typedef struct JSON_Parser JSON_ParserTypeDef;
+
+// 事件回调：path为当前值的完整路径，value以0结尾(JSON_END/JSON_ERROR时为空串)
+typedef void (*JSON_Callback)(JSON_ParserTypeDef *p, JSON_Type type, const char *value, uint8_t len);
+
+// 流式JSON解析器：数据可任意分段喂入，不分配内存，每字节O(1)
+struct JSON_Parser {
+    JSON_Callback callback;         // 事件回调
+    void *ctx;                      // 调用者数据
+    uint8_t state;                  // 词法状态
+    uint8_t depth;                  // 当前打开的容器层数
+    uint8_t is_key;                 // 正在解析的字符串是键名
+    uint8_t literal;                // 正在解析的非字符串标量类型
+    uint8_t unicode;                // \uXXXX剩余的十六进制位数
+    uint8_t array;                  // 各层是否为数组(位图)
+    uint8_t path_len;               // 当前值的路径长度
+    uint8_t base[JSON_MAX_DEPTH];   // 各层容器自身的路径长度
+    uint16_t index[JSON_MAX_DEPTH]; // 各层数组的当前元素序号
+    uint8_t value_len;
+    char path[JSON_PATH_MAX + 1];
+    char value[JSON_VALUE_MAX + 1];
+};
+
+// 函数声明
+void JSON_Init(JSON_ParserTypeDef *p, JSON_Callback callback, void *ctx);
+void JSON_Reset(JSON_ParserTypeDef *p);
+void JSON_Feed(JSON_ParserTypeDef *p, const char *data, uint16_t len);
+uint8_t JSON_PathIs(const JSON_ParserTypeDef *p, const char *path);
+uint16_t JSON_Index(const JSON_ParserTypeDef *p, uint8_t up);
+#ifdef JSON_BENCHMARK
+void JSON_Benchmark(void);
+#endif
+
+#endif /* __JSON_H */
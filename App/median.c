@@ -0,0 +1,267 @@
+#include "median.h"
+#include "perf.h"
+
+// 当前使用的中位数算法
+static MEDIAN_Method_TypeDef median_method = MEDIAN_DEFAULT_METHOD;
+
+/**
+  * @brief  设置中位数算法
+  * @param  method: 算法类型
+  * @retval None
+  */
+void MEDIAN_SetMethod(MEDIAN_Method_TypeDef method)
+{
+    median_method = method;
+}
+
+/**
+  * @brief  获取当前中位数算法
+  * @retval 算法类型
+  */
+MEDIAN_Method_TypeDef MEDIAN_GetMethod(void)
+{
+    return median_method;
+}
+
+/**
+  * @brief  使用当前算法求中位数
+  * @param  data: 数据指针(快速选择法会打乱数据顺序)
+  * @param  len: 数据长度
+  * @retval 中位数(排序后第len/2个元素)
+  */
+uint16_t MEDIAN_Get(uint16_t *data, uint16_t len)
+{
+    if (len == 0)
+    {
+        return 0;
+    }
+
+    if (median_method == MEDIAN_HISTOGRAM)
+    {
+        return MEDIAN_Histogram(data, len, len / 2);
+    }
+
+    return MEDIAN_QuickSelect(data, len, len / 2);
+}
+
+/**
+  * @brief  快速选择，求第k小的元素
+  * @param  data: 数据指针，结束后data[k]为结果，左侧不大于它，右侧不小于它
+  * @param  len: 数据长度
+  * @param  k: 目标序号(0起)
+  * @retval 第k小的元素
+  * @note   三数取中选枢轴，迭代实现，不占用递归栈
+  */
+uint16_t MEDIAN_QuickSelect(uint16_t *data, uint16_t len, uint16_t k)
+{
+    int32_t left = 0;
+    int32_t right = len - 1;
+    uint16_t temp;
+
+    if (len == 0)
+    {
+        return 0;
+    }
+    if (k >= len)
+    {
+        k = len - 1;
+    }
+
+    for (;;)
+    {
+        if (right <= left + 1)
+        {
+            // 只剩一到两个元素
+            if (right == left + 1 && data[right] < data[left])
+            {
+                temp = data[left]; data[left] = data[right]; data[right] = temp;
+            }
+            break;
+        }
+
+        // 三数取中，使data[left] <= data[left+1] <= data[right]，枢轴为data[left+1]
+        int32_t mid = (left + right) >> 1;
+
+        temp = data[mid]; data[mid] = data[left + 1]; data[left + 1] = temp;
+        if (data[left] > data[right])
+        {
+            temp = data[left]; data[left] = data[right]; data[right] = temp;
+        }
+        if (data[left + 1] > data[right])
+        {
+            temp = data[left + 1]; data[left + 1] = data[right]; data[right] = temp;
+        }
+        if (data[left] > data[left + 1])
+        {
+            temp = data[left]; data[left] = data[left + 1]; data[left + 1] = temp;
+        }
+
+        uint16_t pivot = data[left + 1];
+        int32_t i = left + 1;
+        int32_t j = right;
+
+        // Hoare划分，data[left]和data[right]作为两端哨兵
+        for (;;)
+        {
+            do { i++; } while (data[i] < pivot);
+            do { j--; } while (data[j] > pivot);
+            if (j < i)
+            {
+                break;
+            }
+            temp = data[i]; data[i] = data[j]; data[j] = temp;
+        }
+
+        // 枢轴归位
+        data[left + 1] = data[j];
+        data[j] = pivot;
+
+        // 只在包含k的一侧继续
+        if (j >= k)
+        {
+            right = j - 1;
+        }
+        if (j <= k)
+        {
+            left = i;
+        }
+    }
+
+    return data[k];
+}
+
+/**
+  * @brief  两级直方图法求第k小的元素
+  * @param  data: 数据指针(只读)
+  * @param  len: 数据长度
+  * @param  k: 目标序号(0起)
+  * @retval 第k小的元素
+  * @note   等效于4096格计数直方图，但只需64个计数器(128字节栈)，两遍复用
+  *         第一遍统计高6位，定位目标所在粗格；第二遍只统计该粗格内的低6位
+  */
+uint16_t MEDIAN_Histogram(const uint16_t *data, uint16_t len, uint16_t k)
+{
+    uint16_t hist[MEDIAN_HIST_BINS];
+    uint16_t i, bin, coarse;
+    uint16_t below = 0;
+
+    if (len == 0)
+    {
+        return 0;
+    }
+    if (k >= len)
+    {
+        k = len - 1;
+    }
+
+    // 第一遍：高6位计数
+    for (i = 0; i < MEDIAN_HIST_BINS; i++)
+    {
+        hist[i] = 0;
+    }
+    for (i = 0; i < len; i++)
+    {
+        hist[(data[i] >> MEDIAN_HIST_BITS) & (MEDIAN_HIST_BINS - 1)]++;
+    }
+
+    for (bin = 0; bin < MEDIAN_HIST_BINS - 1; bin++)
+    {
+        if (below + hist[bin] > k)
+        {
+            break;
+        }
+        below += hist[bin];
+    }
+    coarse = bin;
+
+    // 第二遍：只统计落在目标粗格内的低6位
+    for (i = 0; i < MEDIAN_HIST_BINS; i++)
+    {
+        hist[i] = 0;
+    }
+    for (i = 0; i < len; i++)
+    {
+        if (((data[i] >> MEDIAN_HIST_BITS) & (MEDIAN_HIST_BINS - 1)) == coarse)
+        {
+            hist[data[i] & (MEDIAN_HIST_BINS - 1)]++;
+        }
+    }
+
+    for (bin = 0; bin < MEDIAN_HIST_BINS - 1; bin++)
+    {
+        if (below + hist[bin] > k)
+        {
+            break;
+        }
+        below += hist[bin];
+    }
+
+    return (coarse << MEDIAN_HIST_BITS) | bin;
+}
+
+#ifdef MEDIAN_BENCHMARK
+#include <stdio.h>
+
+// 基准测试用缓冲区(仅在开启MEDIAN_BENCHMARK时占用RAM)
+#define MEDIAN_BENCH_MAX_LEN 1024
+#define MEDIAN_BENCH_ROUNDS  20
+static uint16_t bench_src[MEDIAN_BENCH_MAX_LEN];
+static uint16_t bench_work[MEDIAN_BENCH_MAX_LEN];
+
+/**
+  * @brief  中位数算法基准测试，通过RTT输出每次调用的周期数和耗时
+  * @note   测试长度100/256/1024，数据为伪随机12位值
+  * @retval None
+  */
+void MEDIAN_Benchmark(void)
+{
+    static const uint16_t sizes[] = {100, 256, 1024};
+    static const char *names[] = {"quickselect", "histogram"};
+    PERF_Stat_TypeDef stat;
+    uint32_t seed = 12345;
+    uint32_t start;
+    char label[32];
+    volatile uint16_t result;   // 直方图法不修改数据，结果不用时调用会被编译器整个删掉
+
+    PERF_Init();
+
+    for (uint16_t i = 0; i < MEDIAN_BENCH_MAX_LEN; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        bench_src[i] = (seed >> 16) & 0x0FFF;
+    }
+
+    for (uint8_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        uint16_t len = sizes[s];
+
+        for (uint8_t m = 0; m < 2; m++)
+        {
+            PERF_Reset(&stat);
+            for (uint8_t r = 0; r < MEDIAN_BENCH_ROUNDS; r++)
+            {
+                // 快速选择会打乱数据，每轮从原始数据重新复制(复制不计入耗时)
+                for (uint16_t i = 0; i < len; i++)
+                {
+                    bench_work[i] = bench_src[(i + r) % MEDIAN_BENCH_MAX_LEN];
+                }
+
+                start = PERF_CYCLES();
+                if (m == 0)
+                {
+                    result = MEDIAN_QuickSelect(bench_work, len, len / 2);
+                }
+                else
+                {
+                    result = MEDIAN_Histogram(bench_work, len, len / 2);
+                }
+                PERF_Record(&stat, PERF_CYCLES() - start);
+            }
+
+            sprintf(label, "median %s len=%u", names[m], len);
+            PERF_Print(label, &stat);
+        }
+    }
+    (void)result;
+}
+#endif
@@ -0,0 +1,33 @@
+#ifndef __MEDIAN_H
+#define __MEDIAN_H
+
+#include "main.h"
+
+// ADC为12位，直方图法按高6位/低6位分两级统计
+#define MEDIAN_ADC_BITS      12
+#define MEDIAN_HIST_BITS     6
+#define MEDIAN_HIST_BINS     (1 << MEDIAN_HIST_BITS)
+
+// 中位数算法选择
+typedef enum {
+    MEDIAN_QUICKSELECT,  // 快速选择，平均O(n)，会打乱输入数据
+    MEDIAN_HISTOGRAM     // 两级直方图，固定2n+128次操作，不修改输入数据
+} MEDIAN_Method_TypeDef;
+
+// 默认算法
+#ifndef MEDIAN_DEFAULT_METHOD
+#define MEDIAN_DEFAULT_METHOD MEDIAN_QUICKSELECT
+#endif
+
+// 函数声明
+void MEDIAN_SetMethod(MEDIAN_Method_TypeDef method);
+MEDIAN_Method_TypeDef MEDIAN_GetMethod(void);
+uint16_t MEDIAN_Get(uint16_t *data, uint16_t len);
+uint16_t MEDIAN_QuickSelect(uint16_t *data, uint16_t len, uint16_t k);
+uint16_t MEDIAN_Histogram(const uint16_t *data, uint16_t len, uint16_t k);
+
+#ifdef MEDIAN_BENCHMARK
+void MEDIAN_Benchmark(void);
+#endif
+
+#endif /* __MEDIAN_H */
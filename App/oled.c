@@ -1,10 +1,221 @@
 #include "oled.h"
-#include "oledfont.h"
+#include "oledfont_pack.h"
+#include "perf.h"
 #include "gpio.h"
 #include "spi.h"
+#include <string.h>
 
-// OLED缓存区，用于存储显示内容
-static uint8_t OLED_Buffer[128][8];
+// OLED缓存区(按页存放，每页128列连续)，刷新后与屏幕GDDRAM内容一致
+static uint8_t OLED_Buffer[OLED_PAGES][OLED_WIDTH];
+
+// 后台缓存：合成下一页面和过渡动画的目标画面
+static uint8_t OLED_Back[OLED_PAGES][OLED_WIDTH];
+static uint8_t compose_active = 0;            // 1:BeginFrame后绘制写入后台缓存
+static uint16_t clear_count = 0;              // 绘制目标被清空的次数，保留模式控件据此判断是否需要整体重绘
+static OLED_Transition_TypeDef trans_type = OLED_TRANS_NONE; // 进行中的过渡，NONE表示无过渡
+static uint8_t trans_step;                    // 已完成的过渡步数
+static uint32_t trans_tick;                   // 上一步的时刻
+
+// 4x4有序抖动矩阵，淡入时阈值小于步数的像素先切换到新画面
+static const uint8_t OLED_Bayer[4][4] = {
+    { 0,  8,  2, 10},
+    {12,  4, 14,  6},
+    { 3, 11,  1,  9},
+    {15,  7, 13,  5}
+};
+
+// 每页待刷新的列范围[dirty_min, dirty_max]，dirty_min > dirty_max表示该页无变化
+static uint8_t dirty_min[OLED_PAGES] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+static uint8_t dirty_max[OLED_PAGES];
+
+// DMA刷新状态：启动时把dirty范围拷贝到flush_min/flush_max，之后由SPI完成中断逐页推进
+typedef enum {
+    OLED_FLUSH_CMD = 0,   // 下一步发送页地址命令
+    OLED_FLUSH_DATA       // 下一步发送该页数据
+} OLED_FlushPhase_TypeDef;
+
+static volatile uint8_t flush_busy = 0;       // 1:DMA刷新进行中
+static volatile uint8_t flush_failed = 0;     // 1:上次刷新出错，下次整屏重写
+static uint8_t flush_page;                    // 当前刷新的页
+static OLED_FlushPhase_TypeDef flush_phase;
+static uint8_t flush_min[OLED_PAGES];
+static uint8_t flush_max[OLED_PAGES];
+static uint8_t flush_full;                    // 1:本次按整帧发送
+static uint8_t flush_cmd[6];                  // 列/页窗口命令，DMA期间必须保持有效
+static OLED_FlushMode_TypeDef flush_mode = OLED_FLUSH_AUTO;
+
+static void OLED_FlushNext(void);
+static void OLED_TransitionStep(void);
+
+// SPI传输统计，作为显示优化的对比基准
+static OLED_Stat_TypeDef oled_stat;
+static OLED_Stat_TypeDef frame_start;          // 本次刷新开始时的统计值
+static uint8_t dc_level = 0xFF;                // 当前DC电平，0xFF表示未知
+
+#ifdef OLED_MIRROR
+// 屏幕镜像：按SSD1306协议解码发出的命令和数据，重建屏幕GDDRAM内容
+static uint8_t mirror[OLED_PAGES][OLED_WIDTH];
+static uint8_t mirror_page;
+static uint8_t mirror_col;
+static uint8_t mirror_mode = 0x02;             // 内存地址模式：0水平 1垂直 2页(复位默认)
+static uint8_t mirror_col_start = 0, mirror_col_end = OLED_WIDTH - 1;
+static uint8_t mirror_page_start = 0, mirror_page_end = OLED_PAGES - 1;
+static uint8_t mirror_cmd;                     // 等待参数的命令
+static uint8_t mirror_args;                    // 还需要的参数字节数
+static uint8_t mirror_arg[2];
+
+static void OLED_MirrorDecode(uint8_t dc, const uint8_t *buf, uint16_t len);
+#endif
+
+// 初始化命令序列，一次性发送
+static const uint8_t OLED_InitCmd[] = {
+    0xAE,       // 关闭显示
+    0xD5, 0x80, // 设置显示时钟分频比/振荡器频率
+    0xA8, 0x3F, // 设置多路复用率
+    0xD3, 0x00, // 设置显示偏移
+    0x40,       // 设置显示开始行
+    0x8D, 0x14, // 充电泵设置
+    0x20, 0x00, // 设置内存地址模式：水平模式，由列/页窗口(0x21/0x22)定位
+    0xA1,       // 段重定义
+    0xC8,       // COM扫描方向
+    0xDA, 0x12, // COM硬件配置
+    0x81, 0xCF, // 对比度设置
+    0xD9, 0xF1, // 设置预充电周期
+    0xDB, 0x30, // 设置VCOMH取消选择级别
+    0xA4,       // 输出遵循RAM内容
+    0xA6,       // 设置正常显示
+    0xAF        // 开启显示
+};
+
+/**
+ * @brief 把一段连续列写入前台缓存的同一页，整段比较完后只更新一次待刷新范围
+ * @param x 起始列地址(0-127)
+ * @param page 页地址(0-7)
+ * @param data 字节数据
+ * @param len 字节数，调用者保证不超出屏幕
+ */
+static void OLED_UpdateSpan(uint8_t x, uint8_t page, const uint8_t *data, uint8_t len)
+{
+    uint8_t first = 0xFF;
+    uint8_t last = 0;
+    uint8_t *dst = &OLED_Buffer[page][x];
+    for (uint8_t i = 0; i < len; i++)
+    {
+        if (dst[i] != data[i])
+        {
+            dst[i] = data[i];
+            if (first == 0xFF)
+            {
+                first = i;
+            }
+            last = i;
+        }
+    }
+    
+    if (first == 0xFF)
+    {
+        return;
+    }
+    if (x + first < dirty_min[page])
+    {
+        dirty_min[page] = x + first;
+    }
+    if (x + last > dirty_max[page])
+    {
+        dirty_max[page] = x + last;
+    }
+}
+
+/**
+ * @brief 绘制一段连续列
+ * @param x 起始列地址(0-127)
+ * @param page 页地址(0-7)
+ * @param data 字节数据
+ * @param len 字节数，超出屏幕部分被裁掉
+ * @note 合成或过渡期间写入后台缓存，否则写入前台缓存并标记待刷新
+ */
+static void OLED_SetSpan(uint8_t x, uint8_t page, const uint8_t *data, uint8_t len)
+{
+    if (x >= OLED_WIDTH || page >= OLED_PAGES)
+    {
+        return;
+    }
+    if (len > OLED_WIDTH - x)
+    {
+        len = OLED_WIDTH - x;
+    }
+    
+    if (compose_active || trans_type != OLED_TRANS_NONE)
+    {
+        memcpy(&OLED_Back[page][x], data, len);
+    }
+    else
+    {
+        OLED_UpdateSpan(x, page, data, len);
+    }
+}
+
+/**
+ * @brief 标记整屏待刷新
+ * @note 上电后屏幕内容未知，初始化时强制整屏写一次
+ */
+void OLED_Invalidate(void)
+{
+    for (uint8_t i = 0; i < OLED_PAGES; i++)
+    {
+        dirty_min[i] = 0;
+        dirty_max[i] = OLED_WIDTH - 1;
+    }
+}
+
+/**
+ * @brief 设置DC电平并记录一次即将开始的SPI传输
+ * @param dc 0:命令 1:数据
+ * @param buf 待发送的字节
+ * @param len 字节数
+ * @note 所有写屏路径(阻塞和DMA)都经过这里，统计字节数、传输次数和DC切换次数
+ */
+static void OLED_BeginTransfer(uint8_t dc, const uint8_t *buf, uint16_t len)
+{
+    if (dc != dc_level)
+    {
+        HAL_GPIO_WritePin(OLED_DC_GPIO_Port, OLED_DC_Pin, dc ? GPIO_PIN_SET : GPIO_PIN_RESET);
+        dc_level = dc;
+        oled_stat.dc_toggles++;
+    }
+    oled_stat.bytes += len;
+    oled_stat.transfers++;
+    
+#ifdef OLED_MIRROR
+    OLED_MirrorDecode(dc, buf, len);
+#else
+    (void)buf;
+#endif
+}
+
+/**
+ * @brief OLED连续写多个命令字节(一次DC切换、一次SPI传输)
+ * @param cmd 命令序列
+ * @param len 字节数
+ */
+void OLED_Write_Commands(const uint8_t *cmd, uint16_t len)
+{
+    while (flush_busy);                    // 等待DMA刷新结束，避免打断传输
+    OLED_BeginTransfer(0, cmd, len);       // 命令模式
+    HAL_SPI_Transmit(&hspi2, (uint8_t *)cmd, len, HAL_MAX_DELAY);
+}
+
+/**
+ * @brief OLED连续写多个数据字节(一次DC切换、一次SPI传输)
+ * @param data 数据序列
+ * @param len 字节数
+ */
+void OLED_Write_DataSpan(const uint8_t *data, uint16_t len)
+{
+    while (flush_busy);
+    OLED_BeginTransfer(1, data, len);      // 数据模式
+    HAL_SPI_Transmit(&hspi2, (uint8_t *)data, len, HAL_MAX_DELAY);
+}
 
 /**
  * @brief OLED写命令
@@ -12,8 +223,7 @@ static uint8_t OLED_Buffer[128][8];
  */
 void OLED_Write_Command(uint8_t cmd)
 {
-    HAL_GPIO_WritePin(OLED_DC_GPIO_Port, OLED_DC_Pin, GPIO_PIN_RESET); // 命令模式
-    HAL_SPI_Transmit(&hspi2, &cmd, 1, HAL_MAX_DELAY);                  // 发送命令
+    OLED_Write_Commands(&cmd, 1);
 }
 
 /**
@@ -22,8 +232,7 @@ void OLED_Write_Command(uint8_t cmd)
  */
 void OLED_Write_Data(uint8_t data)
 {
-    HAL_GPIO_WritePin(OLED_DC_GPIO_Port, OLED_DC_Pin, GPIO_PIN_SET);   // 数据模式
-    HAL_SPI_Transmit(&hspi2, &data, 1, HAL_MAX_DELAY);                 // 发送数据
+    OLED_Write_DataSpan(&data, 1);
 }
 
 /**
@@ -36,52 +245,226 @@ void OLED_Init(void)
     HAL_Delay(100);
     HAL_GPIO_WritePin(OLED_RES_GPIO_Port, OLED_RES_Pin, GPIO_PIN_SET);
     
-    OLED_Write_Command(0xAE); // 关闭显示
-    OLED_Write_Command(0xD5); // 设置显示时钟分频比/振荡器频率
-    OLED_Write_Command(0x80);
-    OLED_Write_Command(0xA8); // 设置多路复用率
-    OLED_Write_Command(0x3F);
-    OLED_Write_Command(0xD3); // 设置显示偏移
-    OLED_Write_Command(0x00);
-    OLED_Write_Command(0x40); // 设置显示开始行
-    OLED_Write_Command(0x8D); // 充电泵设置
-    OLED_Write_Command(0x14);
-    OLED_Write_Command(0x20); // 设置内存地址模式
-    OLED_Write_Command(0x02);
-    OLED_Write_Command(0xA1); // 段重定义
-    OLED_Write_Command(0xC8); // COM扫描方向
-    OLED_Write_Command(0xDA); // COM硬件配置
-    OLED_Write_Command(0x12);
-    OLED_Write_Command(0x81); // 对比度设置
-    OLED_Write_Command(0xCF);
-    OLED_Write_Command(0xD9); // 设置预充电周期
-    OLED_Write_Command(0xF1);
-    OLED_Write_Command(0xDB); // 设置VCOMH取消选择级别
-    OLED_Write_Command(0x30);
-    OLED_Write_Command(0xA4); // 输出遵循RAM内容
-    OLED_Write_Command(0xA6); // 设置正常显示
-    OLED_Write_Command(0xAF); // 开启显示
+    OLED_Write_Commands(OLED_InitCmd, sizeof(OLED_InitCmd));
     
     OLED_Clear();             // 清屏
+    OLED_Invalidate();
+    OLED_Refresh();
 }
 
 /**
  * @brief OLED清屏
- * @note 将显存全部清零并更新显示
+ * @note 只清空缓存，OLED_Refresh时写出；紧接着重绘的内容与原内容相同的部分不会产生SPI传输
  */
 void OLED_Clear(void)
 {
-    for(uint8_t i = 0; i < 8; i++)
+    static const uint8_t blank[OLED_WIDTH] = {0};
+    
+    clear_count++;
+    for(uint8_t i = 0; i < OLED_PAGES; i++)
+    {
+        OLED_SetSpan(0, i, blank, OLED_WIDTH);
+    }
+}
+
+/**
+ * @brief 把缓存中有变化的区域写到屏幕(阻塞)
+ * @note 用于初始化和4G连接等本身就阻塞的流程，主循环中使用OLED_StartFlush
+ */
+void OLED_Refresh(void)
+{
+    // 阻塞刷新要求立即看到结果，进行中的过渡直接跳到最后一帧
+    while (trans_type != OLED_TRANS_NONE)
     {
-        OLED_Write_Command(0xb0 + i); // 设置页地址
-        OLED_Write_Command(0x00);     // 设置列地址低4位
-        OLED_Write_Command(0x10);     // 设置列地址高4位
+        trans_step = OLED_TRANS_STEPS - 1;
+        OLED_TransitionStep();
+    }
+    
+    while (flush_busy);
+    OLED_StartFlush();
+    while (flush_busy);
+}
+
+/**
+ * @brief 启动一次DMA刷新，立即返回
+ * @retval HAL_OK 已启动或无需刷新，HAL_BUSY 上一次刷新尚未完成
+ * @note 每个有变化的页设置一次列/页窗口，然后用DMA连续写出变化的列范围；
+ *       变化分散到多数页时改为整帧窗口，一次DMA写出1024字节(见OLED_SetFlushMode)；
+ *       传输期间缓存仍可绘制，被改动的区域会重新标记，由下一次刷新写出
+ */
+HAL_StatusTypeDef OLED_StartFlush(void)
+{
+    uint8_t pending = 0;
+    
+    if (flush_busy)
+    {
+        return HAL_BUSY;
+    }
+    
+    // 上一帧写完后再推进过渡，保证每一步都能完整显示
+    if (trans_type != OLED_TRANS_NONE && HAL_GetTick() - trans_tick >= OLED_TRANS_STEP_MS)
+    {
+        OLED_TransitionStep();
+    }
+    
+    if (flush_failed)
+    {
+        flush_failed = 0;
+        OLED_Invalidate(); // 出错时不确定屏幕写到哪里，整屏重写
+    }
+    
+    // 逐页发送的代价：每页一次窗口命令和一次数据传输
+    uint16_t page_cost = 0;
+    for(uint8_t i = 0; i < OLED_PAGES; i++)
+    {
+        flush_min[i] = dirty_min[i];
+        flush_max[i] = dirty_max[i];
+        if (dirty_min[i] <= dirty_max[i])
+        {
+            pending = 1;
+            page_cost += sizeof(flush_cmd) + (dirty_max[i] - dirty_min[i] + 1) + 2 * OLED_XFER_COST;
+        }
+        dirty_min[i] = 0xFF;
+        dirty_max[i] = 0;
+    }
+    
+    if (!pending)
+    {
+        return HAL_OK;
+    }
+    
+    // 整帧发送的代价固定：一次窗口命令和一次1024字节传输
+    if (flush_mode == OLED_FLUSH_AUTO)
+    {
+        flush_full = page_cost > sizeof(flush_cmd) + sizeof(OLED_Buffer) + 2 * OLED_XFER_COST;
+    }
+    else
+    {
+        flush_full = (flush_mode == OLED_FLUSH_FULL);
+    }
+    
+    flush_page = 0;
+    flush_phase = OLED_FLUSH_CMD;
+    frame_start = oled_stat;
+    oled_stat.frames++;
+    flush_busy = 1;
+    OLED_FlushNext();
+    
+    return HAL_OK;
+}
+
+/**
+ * @brief 查询DMA刷新是否进行中
+ * @retval 1:进行中 0:空闲
+ */
+uint8_t OLED_IsBusy(void)
+{
+    return flush_busy;
+}
+
+/**
+ * @brief 发送刷新序列的下一段(页地址命令或页数据)
+ * @note 由OLED_StartFlush和SPI2发送完成中断调用；HAL在完成回调前已等待BSY清零，
+ *       因此这里切换DC不会影响上一段的最后一个字节
+ */
+static void OLED_FlushNext(void)
+{
+    HAL_StatusTypeDef status;
+    
+    if (flush_full && flush_page < OLED_PAGES)
+    {
+        // 整帧：窗口设为整屏，水平模式下1024字节一次传完
+        if (flush_phase == OLED_FLUSH_CMD)
+        {
+            flush_cmd[0] = 0x21;
+            flush_cmd[1] = 0;
+            flush_cmd[2] = OLED_WIDTH - 1;
+            flush_cmd[3] = 0x22;
+            flush_cmd[4] = 0;
+            flush_cmd[5] = OLED_PAGES - 1;
+            flush_phase = OLED_FLUSH_DATA;
+            OLED_BeginTransfer(0, flush_cmd, sizeof(flush_cmd));
+            status = HAL_SPI_Transmit_DMA(&hspi2, flush_cmd, sizeof(flush_cmd));
+        }
+        else
+        {
+            flush_phase = OLED_FLUSH_CMD;
+            flush_page = OLED_PAGES;
+            OLED_BeginTransfer(1, &OLED_Buffer[0][0], sizeof(OLED_Buffer));
+            status = HAL_SPI_Transmit_DMA(&hspi2, &OLED_Buffer[0][0], sizeof(OLED_Buffer));
+        }
+    }
+    else if (flush_phase == OLED_FLUSH_DATA)
+    {
+        uint8_t page = flush_page;
+        uint8_t x = flush_min[page];
+        uint16_t len = flush_max[page] - x + 1;
         
-        for(uint8_t j = 0; j < 128; j++)
+        // 状态必须在启动DMA前推进：短传输可能在HAL_SPI_Transmit_DMA返回前就进入完成中断
+        flush_phase = OLED_FLUSH_CMD;
+        flush_page++;
+        OLED_BeginTransfer(1, &OLED_Buffer[page][x], len);           // 数据模式
+        status = HAL_SPI_Transmit_DMA(&hspi2, &OLED_Buffer[page][x], len);
+    }
+    else
+    {
+        // 跳过无变化的页
+        while (flush_page < OLED_PAGES && flush_min[flush_page] > flush_max[flush_page])
         {
-            OLED_Write_Data(0x00);
-            OLED_Buffer[j][i] = 0x00;
+            flush_page++;
         }
+        
+        if (flush_page >= OLED_PAGES)
+        {
+            oled_stat.frame_bytes = oled_stat.bytes - frame_start.bytes;
+            oled_stat.frame_transfers = oled_stat.transfers - frame_start.transfers;
+            oled_stat.frame_dc_toggles = oled_stat.dc_toggles - frame_start.dc_toggles;
+            flush_busy = 0;
+            return;
+        }
+        
+        // 窗口设为该页的变化列范围
+        flush_cmd[0] = 0x21;
+        flush_cmd[1] = flush_min[flush_page];
+        flush_cmd[2] = flush_max[flush_page];
+        flush_cmd[3] = 0x22;
+        flush_cmd[4] = flush_page;
+        flush_cmd[5] = flush_page;
+        
+        flush_phase = OLED_FLUSH_DATA;
+        OLED_BeginTransfer(0, flush_cmd, sizeof(flush_cmd));        // 命令模式
+        status = HAL_SPI_Transmit_DMA(&hspi2, flush_cmd, sizeof(flush_cmd));
+    }
+    
+    if (status != HAL_OK)
+    {
+        flush_failed = 1;
+        flush_busy = 0;
+    }
+}
+
+/**
+ * @brief SPI发送完成回调函数
+ * @param hspi SPI句柄
+ */
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+    if (hspi->Instance == SPI2 && flush_busy)
+    {
+        OLED_FlushNext();
+    }
+}
+
+/**
+ * @brief SPI错误回调函数
+ * @param hspi SPI句柄
+ */
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi)
+{
+    if (hspi->Instance == SPI2)
+    {
+        flush_failed = 1;
+        flush_busy = 0;
     }
 }
 
@@ -89,45 +472,62 @@ void OLED_Clear(void)
  * @brief 设置OLED显示位置
  * @param x 列地址(0-127)
  * @param y 页地址(0-7)
+ * @note 水平地址模式下用列/页窗口定位，窗口延伸到屏幕右下角，写到行尾后接着写下一页
  */
 void OLED_SetPos(uint8_t x, uint8_t y)
 {
-    OLED_Write_Command(0xb0 + y);
-    OLED_Write_Command(((x & 0xf0) >> 4) | 0x10);
-    OLED_Write_Command(x & 0x0f);
+    uint8_t cmd[6];
+    
+    cmd[0] = 0x21;
+    cmd[1] = x;
+    cmd[2] = OLED_WIDTH - 1;
+    cmd[3] = 0x22;
+    cmd[4] = y;
+    cmd[5] = OLED_PAGES - 1;
+    OLED_Write_Commands(cmd, sizeof(cmd));
 }
 
 /**
- * @brief 显示单个ASCII字符
+ * @brief 设置刷新方式
+ * @param mode OLED_FLUSH_AUTO按代价自动选择；PAGES/FULL强制逐页或整帧，用于动画页面和基准测试
+ */
+void OLED_SetFlushMode(OLED_FlushMode_TypeDef mode)
+{
+    flush_mode = mode;
+}
+
+/**
+ * @brief 显示单个ASCII字符(写入缓存)
  * @param x 起始列地址(0-127)
  * @param y 起始页地址(0-7)
  * @param chr 要显示的字符
  * @param size 字体大小(8/16)
- * @note size=8时使用6x8字体，size=16时使用8x16字体
+ * @note size=8时使用6x8字体，size=16时使用8x16字体，超出屏幕部分被裁掉
  */
 void OLED_ShowChar(uint8_t x, uint8_t y, uint8_t chr, uint8_t size)
 {
-    uint8_t i;
-    chr = chr - ' ';  // 减去空格的ASCII码值(32)，得到字模数组的索引
+    uint8_t glyph[16];
     
     if(size == 16)
     {
-        OLED_SetPos(x, y);
-        // 写入上半部分(8字节)
-        for(i = 0; i < 8; i++)
-            OLED_Write_Data(F8X16[chr*16 + i]);
-        
-        OLED_SetPos(x, y + 1);
-        // 写入下半部分(8字节)
-        for(i = 8; i < 16; i++)
-            OLED_Write_Data(F8X16[chr*16 + i]);
+#if FONT_HAS_8X16
+        // 解码后上半部分(8字节)和下半部分(8字节)各作为一段写入
+        if (FONT_Decode(&Font8x16, chr, glyph))
+        {
+            OLED_SetSpan(x, y, glyph, 8);
+            OLED_SetSpan(x, y + 1, &glyph[8], 8);
+        }
+#endif
     }
     else if(size == 8)
     {
-        OLED_SetPos(x, y);
-        // 写入6x8字体数据
-        for(i = 0; i < 6; i++)
-            OLED_Write_Data(F6x8[chr][i]);
+#if FONT_HAS_6X8
+        // 6x8字体数据
+        if (FONT_Decode(&Font6x8, chr, glyph))
+        {
+            OLED_SetSpan(x, y, glyph, 6);
+        }
+#endif
     }
 }
 
@@ -155,23 +555,559 @@ void OLED_ShowString(uint8_t x, uint8_t y, const char *str, uint8_t size)
 }
 
 /**
- * @brief 显示中文字符
+ * @brief 在一页内绘制一段位图(写入缓存)
+ * @param x 起始列地址(0-127)
+ * @param y 页地址(0-7)
+ * @param data 每列一个字节，低位在上
+ * @param width 列数，超出屏幕部分被裁掉
+ */
+void OLED_DrawBitmap(uint8_t x, uint8_t y, const uint8_t *data, uint8_t width)
+{
+    OLED_SetSpan(x, y, data, width);
+}
+
+/**
+ * @brief 把一块区域的内容左移(写入缓存)，右侧空出的列保持原内容，由调用者补画
+ * @param x 区域起始列
+ * @param y 区域起始页
+ * @param width 区域列数
+ * @param pages 区域页数
+ * @param n 左移列数，小于width
+ * @note 用于曲线等按列滚动的内容，只需补画新增的列
+ */
+void OLED_ScrollLeft(uint8_t x, uint8_t y, uint8_t width, uint8_t pages, uint8_t n)
+{
+    uint8_t row[OLED_WIDTH];
+    
+    if (n >= width || x >= OLED_WIDTH)
+    {
+        return;
+    }
+    if (width > OLED_WIDTH - x)
+    {
+        width = OLED_WIDTH - x;
+    }
+    
+    for (uint8_t p = y; p < y + pages && p < OLED_PAGES; p++)
+    {
+        // 读取当前绘制目标：合成或过渡期间为后台缓存
+        if (compose_active || trans_type != OLED_TRANS_NONE)
+        {
+            memcpy(row, &OLED_Back[p][x + n], width - n);
+        }
+        else
+        {
+            memcpy(row, &OLED_Buffer[p][x + n], width - n);
+        }
+        OLED_SetSpan(x, p, row, width - n);
+    }
+}
+
+/**
+ * @brief 获取绘制目标被清空的次数
+ * @retval 计数值，OLED_Clear和OLED_BeginFrame各加1
+ * @note 保留模式控件记录上次绘制时的计数，不一致说明屏幕已被清空或被其他界面占用，需要整体重绘
+ */
+uint16_t OLED_GetClearCount(void)
+{
+    return clear_count;
+}
+
+/**
+ * @brief 按字体大小选择字库
+ * @param size 字体大小(8/16)
+ * @retval 字库指针，未打包该字库时返回NULL
+ */
+static const FONT_TypeDef *OLED_Font(uint8_t size)
+{
+#if FONT_HAS_8X16
+    if (size == 16)
+    {
+        return &Font8x16;
+    }
+#endif
+#if FONT_HAS_6X8
+    if (size == 8)
+    {
+        return &Font6x8;
+    }
+#endif
+    (void)size;
+    return NULL;
+}
+
+/**
+ * @brief 计算字符串按比例宽度显示时的宽度，不绘制
+ * @param str 字符串
+ * @param size 字体大小(8/16)
+ * @retval 宽度(列)
+ */
+uint16_t OLED_MeasureText(const char *str, uint8_t size)
+{
+    const FONT_TypeDef *font = OLED_Font(size);
+    
+    return (font != NULL) ? FONT_MeasureText(font, str) : 0;
+}
+
+/**
+ * @brief 查询单个字符按比例宽度显示时占用的列数(含其后的字间空白)
+ * @param chr 字符
+ * @param size 字体大小(8/16)
+ * @retval 列数，字库中没有该字符时返回0
+ */
+uint8_t OLED_CharAdvance(uint8_t chr, uint8_t size)
+{
+    const FONT_TypeDef *font = OLED_Font(size);
+    uint8_t w;
+    
+    if (font == NULL || (w = FONT_GlyphWidth(font, chr, NULL)) == 0)
+    {
+        return 0;
+    }
+    return w + ((font->metrics != NULL) ? FONT_SPACING : 0);
+}
+
+/**
+ * @brief 按比例宽度显示字符串(写入缓存)
+ * @param x 起始列地址(0-127)
+ * @param y 起始页地址(0-7)
+ * @param str 字符串
+ * @param size 字体大小(8/16)
+ * @param max_width 最大宽度(列)，超出部分被裁掉
+ * @retval 实际占用的列数
+ * @note 每个字符只写出有效列，字间空白列写0，不换行
+ */
+uint8_t OLED_ShowText(uint8_t x, uint8_t y, const char *str, uint8_t size, uint8_t max_width)
+{
+    static const uint8_t blank[FONT_SPACING] = {0};
+    const FONT_TypeDef *font = OLED_Font(size);
+    uint8_t glyph[16];
+    uint8_t end = (max_width > OLED_WIDTH - x) ? OLED_WIDTH : x + max_width;
+    uint8_t cx = x;
+    
+    if (font == NULL || x >= OLED_WIDTH)
+    {
+        return 0;
+    }
+    
+    while (*str != '\0' && cx < end)
+    {
+        uint8_t left;
+        uint8_t w = FONT_GlyphWidth(font, (uint8_t)*str, &left);
+        uint8_t n;
+        
+        if (w == 0 || !FONT_Decode(font, (uint8_t)*str, glyph))
+        {
+            str++;
+            continue;
+        }
+        str++;
+        
+        n = (w > end - cx) ? end - cx : w;
+        for (uint8_t p = 0; p < font->pages; p++)
+        {
+            OLED_SetSpan(cx, y + p, &glyph[p * font->width + left], n);
+        }
+        cx += n;
+        
+        // 字间空白
+        if (font->metrics != NULL && *str != '\0' && cx < end)
+        {
+            n = (FONT_SPACING > end - cx) ? end - cx : FONT_SPACING;
+            for (uint8_t p = 0; p < font->pages; p++)
+            {
+                OLED_SetSpan(cx, y + p, blank, n);
+            }
+            cx += n;
+        }
+    }
+    
+    return cx - x;
+}
+
+/**
+ * @brief 显示中文字符(写入缓存)
  * @param x 起始列地址(0-127)
  * @param y 起始页地址(0-7)
  * @param index 中文字符在字库中的索引
- * @note 使用16x16点阵中文字库
+ * @note 使用16x16点阵中文字库，只有源码中用到的汉字会被gen_font.py打包，其余索引不显示
  */
 void OLED_ShowChinese(uint8_t x, uint8_t y, uint8_t index)
 {
-    uint8_t i;
+#if FONT_HAS_HZK
+    uint8_t glyph[32];
+    
+    // 上半部分(16字节)和下半部分(16字节)
+    if (FONT_Decode(&FontHzk, index, glyph))
+    {
+        OLED_SetSpan(x, y, glyph, 16);
+        OLED_SetSpan(x, y + 1, &glyph[16], 16);
+    }
+#else
+    (void)x;
+    (void)y;
+    (void)index;
+#endif
+}
+
+/**
+ * @brief 开始合成新画面：之后的绘制写入清空的后台缓存，屏幕保持不变
+ * @note 与OLED_EndFrame配对使用；过渡进行中调用时，过渡改为朝新画面继续
+ */
+void OLED_BeginFrame(void)
+{
+    clear_count++;
+    memset(OLED_Back, 0, sizeof(OLED_Back));
+    compose_active = 1;
+}
+
+/**
+ * @brief 结束合成，把后台缓存的画面换到前台
+ * @param trans 过渡方式：NONE一次差分刷新；SLIDE/FADE由OLED_StartFlush按OLED_TRANS_STEP_MS逐步推进
+ */
+void OLED_EndFrame(OLED_Transition_TypeDef trans)
+{
+    compose_active = 0;
+    
+    if (trans_type != OLED_TRANS_NONE)
+    {
+        return; // 已有过渡在进行，目标画面已更新，沿用当前过渡
+    }
+    
+    if (trans == OLED_TRANS_NONE)
+    {
+        for (uint8_t i = 0; i < OLED_PAGES; i++)
+        {
+            OLED_UpdateSpan(0, i, OLED_Back[i], OLED_WIDTH);
+        }
+        return;
+    }
+    
+    trans_type = trans;
+    trans_step = 0;
+    trans_tick = HAL_GetTick() - OLED_TRANS_STEP_MS; // 第一步不等待
+}
+
+/**
+ * @brief 查询是否在合成新画面
+ * @retval 1:BeginFrame之后尚未EndFrame 0:直接绘制到前台
+ */
+uint8_t OLED_IsComposing(void)
+{
+    return compose_active;
+}
+
+/**
+ * @brief 按前后台缓存计算过渡的下一帧，写入前台缓存
+ * @note 滑动：旧画面左移，新画面从右侧进入，旧画面部分原地左移，新画面部分每步从后台重新复制；
+ *       淡入：按4x4抖动矩阵逐步把像素换成新画面，每步的掩码包含前一步，最后一步与后台完全一致
+ */
+static void OLED_TransitionStep(void)
+{
+    uint8_t row[OLED_WIDTH];
+    uint8_t step = trans_step + 1;
+    
+    if (trans_type == OLED_TRANS_SLIDE)
+    {
+        uint8_t shift = OLED_WIDTH / OLED_TRANS_STEPS;
+        uint8_t offset = step * shift;          // 新画面已进入的列数
+        
+        for (uint8_t i = 0; i < OLED_PAGES; i++)
+        {
+            memcpy(row, &OLED_Buffer[i][shift], OLED_WIDTH - offset);
+            memcpy(&row[OLED_WIDTH - offset], OLED_Back[i], offset);
+            OLED_UpdateSpan(0, i, row, OLED_WIDTH);
+        }
+    }
+    else
+    {
+        uint8_t mask[4] = {0};
+        uint8_t level = step * 16 / OLED_TRANS_STEPS;
+        
+        for (uint8_t c = 0; c < 4; c++)
+        {
+            for (uint8_t y = 0; y < 8; y++)
+            {
+                if (OLED_Bayer[y & 3][c] < level)
+                {
+                    mask[c] |= 1 << y;
+                }
+            }
+        }
+        
+        for (uint8_t i = 0; i < OLED_PAGES; i++)
+        {
+            for (uint8_t j = 0; j < OLED_WIDTH; j++)
+            {
+                uint8_t m = mask[j & 3];
+                row[j] = (OLED_Buffer[i][j] & ~m) | (OLED_Back[i][j] & m);
+            }
+            OLED_UpdateSpan(0, i, row, OLED_WIDTH);
+        }
+    }
+    
+    trans_step = step;
+    trans_tick = HAL_GetTick();
+    if (trans_step >= OLED_TRANS_STEPS)
+    {
+        trans_type = OLED_TRANS_NONE;
+    }
+}
+
+/**
+ * @brief 读取SPI传输统计
+ * @param stat 输出统计值
+ */
+void OLED_GetStats(OLED_Stat_TypeDef *stat)
+{
+    *stat = oled_stat;
+}
+
+/**
+ * @brief 清零累计统计(保留最近一帧的统计)
+ */
+void OLED_ResetStats(void)
+{
+    oled_stat.frames = 0;
+    oled_stat.bytes = 0;
+    oled_stat.transfers = 0;
+    oled_stat.dc_toggles = 0;
+    frame_start = oled_stat;
+}
+
+#ifdef OLED_MIRROR
+/**
+ * @brief 解码一段发往屏幕的字节，更新屏幕镜像
+ * @param dc 0:命令 1:数据
+ * @param buf 字节序列
+ * @param len 字节数
+ * @note 支持页地址(0xB0-0xB7)、列地址(0x00-0x1F)、地址模式(0x20)、列/页范围(0x21/0x22)，
+ *       其他带参数的命令只跳过参数；数据按当前地址模式写入并推进地址
+ */
+static void OLED_MirrorDecode(uint8_t dc, const uint8_t *buf, uint16_t len)
+{
+    for (uint16_t i = 0; i < len; i++)
+    {
+        uint8_t b = buf[i];
+        
+        if (dc)
+        {
+            mirror[mirror_page][mirror_col] = b;
+            
+            if (mirror_mode == 0x02)
+            {
+                // 页模式：列到末尾后回到0，页不变
+                mirror_col = (mirror_col + 1) % OLED_WIDTH;
+            }
+            else if (mirror_mode == 0x00)
+            {
+                // 水平模式：列到结束列后换到下一页
+                if (mirror_col >= mirror_col_end)
+                {
+                    mirror_col = mirror_col_start;
+                    mirror_page = (mirror_page >= mirror_page_end) ? mirror_page_start : mirror_page + 1;
+                }
+                else
+                {
+                    mirror_col++;
+                }
+            }
+            else
+            {
+                // 垂直模式：页到结束页后换到下一列
+                if (mirror_page >= mirror_page_end)
+                {
+                    mirror_page = mirror_page_start;
+                    mirror_col = (mirror_col >= mirror_col_end) ? mirror_col_start : mirror_col + 1;
+                }
+                else
+                {
+                    mirror_page++;
+                }
+            }
+            continue;
+        }
+        
+        if (mirror_args > 0)
+        {
+            mirror_arg[(mirror_cmd == 0x21 || mirror_cmd == 0x22) ? 2 - mirror_args : 0] = b;
+            if (--mirror_args > 0)
+            {
+                continue;
+            }
+            
+            if (mirror_cmd == 0x20)
+            {
+                mirror_mode = mirror_arg[0] & 0x03;
+            }
+            else if (mirror_cmd == 0x21)
+            {
+                mirror_col_start = mirror_arg[0] & 0x7F;
+                mirror_col_end = mirror_arg[1] & 0x7F;
+                mirror_col = mirror_col_start;
+            }
+            else if (mirror_cmd == 0x22)
+            {
+                mirror_page_start = mirror_arg[0] & 0x07;
+                mirror_page_end = mirror_arg[1] & 0x07;
+                mirror_page = mirror_page_start;
+            }
+            continue;
+        }
+        
+        // 页地址和列地址半字节命令只在页模式下有效，其他模式下屏幕忽略
+        if (b <= 0x0F)
+        {
+            if (mirror_mode == 0x02)
+            {
+                mirror_col = (mirror_col & 0xF0) | b;
+            }
+        }
+        else if (b <= 0x1F)
+        {
+            if (mirror_mode == 0x02)
+            {
+                mirror_col = ((b & 0x07) << 4) | (mirror_col & 0x0F);
+            }
+        }
+        else if (b >= 0xB0 && b <= 0xB7)
+        {
+            if (mirror_mode == 0x02)
+            {
+                mirror_page = b & 0x07;
+            }
+        }
+        else
+        {
+            mirror_cmd = b;
+            switch (b)
+            {
+                case 0x21:
+                case 0x22:
+                    mirror_args = 2;
+                    break;
+                case 0x20:
+                case 0x81:
+                case 0x8D:
+                case 0xA8:
+                case 0xD3:
+                case 0xD5:
+                case 0xD9:
+                case 0xDA:
+                case 0xDB:
+                    mirror_args = 1;
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief 比较屏幕镜像与显示缓存
+ * @retval 不一致的字节数；刷新进行中或还有待刷新区域时返回0xFFFF
+ * @note 刷新完成后两者应完全一致，不一致说明写屏路径有地址或范围错误
+ */
+uint16_t OLED_MirrorCheck(void)
+{
+    uint16_t diff = 0;
     
-    OLED_SetPos(x, y);
-    // 写入上半部分(16字节)
-    for(i = 0; i < 16; i++)
-        OLED_Write_Data(Hzk[index][i]);
+    if (flush_busy || trans_type != OLED_TRANS_NONE)
+    {
+        return 0xFFFF;
+    }
+    for (uint8_t i = 0; i < OLED_PAGES; i++)
+    {
+        if (dirty_min[i] <= dirty_max[i])
+        {
+            return 0xFFFF;
+        }
+        for (uint8_t j = 0; j < OLED_WIDTH; j++)
+        {
+            if (mirror[i][j] != OLED_Buffer[i][j])
+            {
+                diff++;
+            }
+        }
+    }
+    return diff;
+}
+
+/**
+ * @brief 通过RTT以PBM(P1)格式输出屏幕镜像，用于与基准图像比较
+ * @param name 图像名，输出在注释行中便于从日志中截取
+ */
+void OLED_MirrorDump(const char *name)
+{
+    char line[OLED_WIDTH + 2];
     
-    OLED_SetPos(x, y + 1);
-    // 写入下半部分(16字节)
-    for(i = 16; i < 32; i++)
-        OLED_Write_Data(Hzk[index][i]);
-}
\ No newline at end of file
+    SEGGER_RTT_printf(0, "P1\n# %s\n%u %u\n", name, OLED_WIDTH, OLED_PAGES * 8);
+    for (uint8_t y = 0; y < OLED_PAGES * 8; y++)
+    {
+        for (uint8_t x = 0; x < OLED_WIDTH; x++)
+        {
+            line[x] = (mirror[y >> 3][x] & (1 << (y & 7))) ? '1' : '0';
+        }
+        line[OLED_WIDTH] = '\n';
+        line[OLED_WIDTH + 1] = '\0';
+        SEGGER_RTT_WriteString(0, line);
+    }
+}
+#endif
+
+#ifdef OLED_BENCHMARK
+/**
+ * @brief 按改造前的方式逐字节写出整屏缓存(每字节一次DC切换和一次HAL_SPI_Transmit)
+ * @note 仅用于基准测试对比，写完后清除待刷新标记
+ */
+void OLED_RefreshBytewise(void)
+{
+    for(uint8_t i = 0; i < OLED_PAGES; i++)
+    {
+        OLED_SetPos(0, i);
+        for(uint8_t j = 0; j < OLED_WIDTH; j++)
+        {
+            OLED_Write_Data(OLED_Buffer[i][j]);
+        }
+        
+        dirty_min[i] = 0xFF;
+        dirty_max[i] = 0;
+    }
+}
+#endif
+
+#ifdef OLED_BENCHMARK
+#define OLED_FONT_BENCH_ROUNDS 10
+
+/**
+ * @brief 字模解码和绘制耗时测试，通过RTT输出每个字符的周期数
+ * @note decode只计解码；draw为OLED_ShowChar全过程(解码+写入缓存+标记待刷新)
+ */
+void OLED_FontBenchmark(void)
+{
+    PERF_Stat_TypeDef decode, draw;
+    uint8_t glyph[16];
+    uint32_t start;
+    
+    PERF_Reset(&decode);
+    PERF_Reset(&draw);
+    for (uint8_t r = 0; r < OLED_FONT_BENCH_ROUNDS; r++)
+    {
+        for (uint8_t c = ' '; c <= '~'; c++)
+        {
+            start = PERF_CYCLES();
+            FONT_Decode(&Font8x16, c, glyph);
+            PERF_Record(&decode, PERF_CYCLES() - start);
+            
+            start = PERF_CYCLES();
+            OLED_ShowChar((c % 16) * 8, (c / 16 % 4) * 2, c, 16);
+            PERF_Record(&draw, PERF_CYCLES() - start);
+        }
+    }
+    
+    PERF_Print("font 8x16 decode", &decode);
+    PERF_Print("font 8x16 draw", &draw);
+    OLED_Clear();
+}
+#endif
@@ -2,6 +2,7 @@
 #define __OLED_H
 
 #include "main.h"
+#include "font.h"
 
 #define OLED_RES_Clr()   HAL_GPIO_WritePin(OLED_RES_GPIO_Port, OLED_RES_Pin, GPIO_PIN_RESET)//RES
 #define OLED_RES_Set()   HAL_GPIO_WritePin(OLED_RES_GPIO_Port, OLED_RES_Pin, GPIO_PIN_SET)
@@ -9,11 +10,81 @@
 #define OLED_DC_Clr()    HAL_GPIO_WritePin(OLED_DC_GPIO_Port, OLED_DC_Pin, GPIO_PIN_RESET)//DC
 #define OLED_DC_Set()    HAL_GPIO_WritePin(OLED_DC_GPIO_Port, OLED_DC_Pin, GPIO_PIN_SET) 
 
+// 屏幕尺寸：128列，8页(每页8行)
+#define OLED_WIDTH       128
+#define OLED_PAGES       8
+
+// 一次SPI传输(DMA启动、DC切换、完成中断)的额外开销，折算为字节数，用于选择逐页或整帧刷新
+#define OLED_XFER_COST      8
+
+// 刷新方式
+typedef enum {
+    OLED_FLUSH_AUTO = 0,  // 按代价选择
+    OLED_FLUSH_PAGES,     // 逐页发送变化的列范围
+    OLED_FLUSH_FULL       // 整帧1024字节一次发送
+} OLED_FlushMode_TypeDef;
+
+// 页面过渡：总步数(需整除OLED_WIDTH)和每步间隔
+#define OLED_TRANS_STEPS    8
+#define OLED_TRANS_STEP_MS  30
+
+// SPI传输统计
+typedef struct {
+    uint32_t frames;            // 刷新次数
+    uint32_t bytes;             // 发送字节数(命令+数据)
+    uint32_t transfers;         // SPI传输次数(每次HAL_SPI_Transmit/DMA启动计1次)
+    uint32_t dc_toggles;        // DC电平切换次数
+    uint32_t frame_bytes;       // 最近一帧的字节数
+    uint32_t frame_transfers;   // 最近一帧的传输次数
+    uint32_t frame_dc_toggles;  // 最近一帧的DC切换次数
+} OLED_Stat_TypeDef;
+
+// 页面过渡方式
+typedef enum {
+    OLED_TRANS_NONE = 0,  // 直接切换，一次差分刷新
+    OLED_TRANS_SLIDE,     // 新页面从右侧滑入
+    OLED_TRANS_FADE       // 抖动淡入
+} OLED_Transition_TypeDef;
+
 // 函数声明
 void OLED_Init(void);
 void OLED_Clear(void);
 void OLED_ShowChar(uint8_t x, uint8_t y, uint8_t chr, uint8_t size);
 void OLED_ShowString(uint8_t x, uint8_t y, const char *str, uint8_t size);
+void OLED_ShowChinese(uint8_t x, uint8_t y, uint8_t index);
+uint16_t OLED_MeasureText(const char *str, uint8_t size);
+uint8_t OLED_CharAdvance(uint8_t chr, uint8_t size);
+uint8_t OLED_ShowText(uint8_t x, uint8_t y, const char *str, uint8_t size, uint8_t max_width);
+void OLED_DrawBitmap(uint8_t x, uint8_t y, const uint8_t *data, uint8_t width);
+void OLED_ScrollLeft(uint8_t x, uint8_t y, uint8_t width, uint8_t pages, uint8_t n);
+uint16_t OLED_GetClearCount(void);
+void OLED_GetStats(OLED_Stat_TypeDef *stat);
+void OLED_ResetStats(void);
 void OLED_Refresh(void);
+HAL_StatusTypeDef OLED_StartFlush(void);
+uint8_t OLED_IsBusy(void);
+void OLED_BeginFrame(void);
+void OLED_EndFrame(OLED_Transition_TypeDef trans);
+uint8_t OLED_IsComposing(void);
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi);
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi);
+void OLED_SetPos(uint8_t x, uint8_t y);
+void OLED_SetFlushMode(OLED_FlushMode_TypeDef mode);
+void OLED_Invalidate(void);
+void OLED_Write_Commands(const uint8_t *cmd, uint16_t len);
+void OLED_Write_DataSpan(const uint8_t *data, uint16_t len);
+void OLED_Write_Command(uint8_t cmd);
+void OLED_Write_Data(uint8_t data);
+
+#ifdef OLED_BENCHMARK
+void OLED_RefreshBytewise(void);
+void OLED_FontBenchmark(void);
+#endif
+
+// 定义OLED_MIRROR后按SSD1306协议解码所有写屏字节，重建屏幕内容用于校验和导出图像
+#ifdef OLED_MIRROR
+uint16_t OLED_MirrorCheck(void);
+void OLED_MirrorDump(const char *name);
+#endif
 
 #endif
\ No newline at end of file
@@ -0,0 +1,95 @@
+#ifndef __OLEDFONT_PACK_H
+#define __OLEDFONT_PACK_H
+
+// 由python/gen_font.py从oledfont.h生成，请勿手工修改
+
+#include "font.h"
+
+#define FONT_HAS_6X8 0
+
+#define FONT_HAS_8X16 1
+static const uint8_t Font8x16_Dict[15] = {0x20, 0x80, 0x08, 0x3F, 0xF8, 0x10, 0x01, 0x88, 0x02, 0x40, 0x30, 0x18, 0x04, 0x21, 0x38};
+static const uint16_t Font8x16_Index[95] = {
+    0, 2, 7, 16, 29, 40, 55, 70, 76, 84, 92, 103,
+    111, 117, 123, 126, 135, 147, 153, 166, 177, 189, 200, 213,
+    220, 234, 249, 255, 260, 268, 277, 285, 296, 316, 329, 341,
+    352, 363, 374, 384, 397, 406, 413, 422, 434, 441, 449, 460,
+    473, 483, 499, 511, 522, 529, 539, 550, 564, 580, 589, 600,
+    608, 618, 626, 631, 637, 641, 654, 664, 674, 684, 697, 706,
+    720, 728, 736, 746, 756, 762, 771, 779, 788, 800, 812, 820,
+    834, 842, 851, 861, 875, 887, 900, 910, 917, 922, 929,
+};
+static const uint8_t Font8x16_Data[936] = {
+    0x00,0x00,0x08,0x18,0x4F,0x33,0xA0,0x7E,0x00,0x5F,0x0C,0xF0,0x65,0xF0,0xCF,0x06,
+    0x7F,0x7F,0x9F,0xC0,0xF7,0x89,0xFC,0x0F,0x78,0x9C,0x3C,0xC3,0xCC,0x3E,0x3E,0xF7,
+    0x07,0xFF,0xC2,0xAB,0x0F,0xFF,0xDF,0x1E,0x37,0x7E,0xFF,0x02,0xFF,0x0F,0xE0,0xBD,
+    0xF1,0xCF,0x03,0xF1,0xED,0xF1,0xE0,0x1E,0xFF,0xFF,0x02,0x7F,0x70,0xF1,0xED,0xF2,
+    0x3F,0x24,0xF1,0x9F,0x27,0xD5,0x07,0x00,0x5F,0x16,0xF0,0xE0,0x78,0x78,0xFE,0x0B,
+    0xC8,0xF0,0x7B,0x09,0x1E,0x1E,0x8C,0xBF,0xE0,0x90,0xBF,0x07,0x7F,0x7F,0x99,0x1F,
+    0xF0,0x19,0x98,0x86,0xF0,0xF6,0x88,0x08,0x7F,0xFF,0x06,0x66,0xF1,0xF6,0x66,0x00,
+    0x07,0x1F,0xB0,0xF7,0x00,0x00,0xFE,0x66,0x66,0x66,0x60,0x00,0x06,0xAA,0xF0,0x1E,
+    0x1F,0x60,0xBC,0xF6,0x0B,0xF0,0x66,0x7E,0x7E,0xFE,0x05,0x22,0x5F,0xE0,0xF0,0xF5,
+    0x00,0x5F,0x0F,0x0E,0x3E,0x55,0x40,0x03,0x00,0x7E,0x7E,0xF7,0x02,0x22,0x7F,0x70,
+    0xAF,0x28,0xF2,0x4F,0x22,0xDA,0x7E,0x7E,0xA2,0x77,0xF4,0x8A,0xB0,0x00,0xF1,0x1F,
+    0x0E,0x3C,0x7E,0xFC,0x00,0x54,0xF0,0x7C,0xF2,0x4F,0x24,0x3F,0x24,0x7E,0x7E,0x42,
+    0x77,0x22,0xF1,0x9D,0x00,0xF1,0x1F,0x0E,0x3E,0x7E,0xFE,0x05,0x77,0xBF,0x0F,0xF1,
+    0x10,0x0F,0x11,0xF0,0xE0,0x7E,0x08,0xE2,0x2F,0xC8,0xE2,0x30,0x7E,0x7E,0xF7,0x07,
+    0x22,0x7F,0x70,0xF1,0xCF,0x22,0xDD,0xF2,0x2F,0x1C,0x7E,0x7C,0xFE,0x05,0x22,0x5F,
+    0xE0,0xF3,0x1F,0x22,0xF2,0x2F,0x11,0xF0,0xF0,0x18,0x18,0xFC,0x0F,0xC0,0xAA,0x08,
+    0x0C,0x11,0xF6,0x00,0x7C,0x7E,0x19,0x05,0x26,0x8C,0x25,0x00,0x7F,0x7F,0x99,0x99,
+    0x99,0x9C,0xCC,0xCC,0xCC,0x3E,0x7E,0x25,0x09,0x10,0x52,0xC8,0x60,0x7E,0x38,0xF7,
+    0x0F,0x48,0x22,0x2F,0xF0,0xAF,0x36,0x60,0x7F,0x7F,0xFC,0x0A,0xFC,0x8F,0x28,0xFE,
+    0x85,0xFE,0x0F,0x07,0xBF,0x27,0xF2,0x4F,0x23,0xF1,0x4F,0x0B,0x1C,0xFF,0xFC,0x0E,
+    0xFE,0x00,0xF3,0xCF,0x23,0x88,0xF2,0x7E,0x00,0x3F,0x7F,0x24,0x77,0x7F,0x70,0x03,
+    0x00,0x0F,0x11,0xF0,0xE0,0x7F,0x7F,0xFC,0x0A,0x22,0x22,0xEF,0x07,0xB0,0x00,0x52,
+    0x7F,0x7F,0x24,0x22,0x25,0xFE,0x00,0x30,0x00,0x5F,0x0F,0x7F,0x7F,0x24,0x77,0xFE,
+    0x82,0x50,0x30,0x0F,0x23,0x0B,0x7F,0x17,0x24,0x77,0xFE,0x82,0x50,0x30,0xF0,0x30,
+    0x3F,0x7F,0xFC,0x0A,0x22,0x2E,0xF0,0x7B,0x00,0xF2,0x2F,0x1E,0x80,0xE7,0xFF,0x24,
+    0x22,0x42,0x03,0xD6,0x6D,0x30,0x3E,0x3E,0x22,0x42,0x20,0x03,0x00,0x7C,0x1F,0x22,
+    0x42,0x2F,0xC0,0x11,0x1F,0x7F,0x7F,0x7F,0x24,0x7F,0xC0,0xF2,0x8B,0x20,0x30,0x6F,
+    0x26,0xE0,0x07,0x7F,0x24,0x20,0x30,0x00,0x0A,0x77,0x6B,0x24,0x44,0x42,0x03,0x33,
+    0x00,0xEF,0x77,0x24,0xAF,0xC0,0x24,0x20,0x30,0xF0,0x7B,0x30,0x7F,0x7F,0xFE,0x05,
+    0x22,0x25,0xFE,0x0F,0x0F,0x50,0x00,0x5F,0x0F,0x7F,0x3F,0x24,0x22,0x22,0xFF,0x00,
+    0x3D,0x66,0x60,0x7F,0x7F,0xFE,0x05,0x22,0x25,0xFE,0x0F,0x0F,0xBF,0x24,0xF2,0x4E,
+    0xF5,0x0F,0x4F,0x7F,0xF7,0x24,0x77,0x77,0xF7,0x00,0x30,0xF0,0x3F,0x0C,0xA0,0x7E,
+    0x7E,0xF7,0x07,0x22,0x2E,0xE0,0xDD,0xF2,0x2F,0x1C,0x7F,0x1C,0xB2,0x24,0x22,0xB0,
+    0x30,0xE7,0x7E,0x24,0x22,0x42,0xF1,0xF0,0x00,0x0F,0x1F,0xE7,0x3C,0x2F,0x78,0x7F,
+    0xC8,0xE2,0xF0,0x7E,0xF0,0xE6,0x6B,0x77,0x42,0x42,0x4F,0x03,0xF3,0xCF,0x07,0xF0,
+    0x7F,0x3C,0xF0,0x30,0xFF,0xFF,0x2B,0xF6,0x81,0x1F,0x68,0xB2,0x0A,0xF2,0xCF,0x03,
+    0xF0,0x3F,0x2C,0xA0,0x77,0x1C,0x2E,0xFC,0x8F,0xC8,0xE2,0x03,0x00,0x7F,0x7F,0x52,
+    0x22,0xFC,0x8E,0x20,0xEF,0x26,0xD0,0x0B,0x78,0x78,0xFF,0xE8,0x88,0xF7,0xF9,0x99,
+    0x0E,0x78,0xF0,0xCA,0xFC,0x06,0xF0,0x6E,0xFC,0x00,0x1E,0x1E,0x88,0x8F,0xFE,0x99,
+    0x9F,0x7F,0x7C,0x00,0xC8,0x88,0xC0,0x00,0xFF,0x11,0x11,0x11,0x11,0x0E,0x00,0x88,
+    0xC0,0x3C,0xFE,0x11,0x11,0xF1,0x9F,0x24,0xF2,0x2F,0x22,0xF2,0x23,0x00,0x1B,0x7E,
+    0x24,0x11,0x3F,0x11,0x00,0xF1,0x1F,0x0E,0x38,0x7E,0x11,0x1F,0x0E,0xF1,0x10,0x00,
+    0xF1,0x10,0x78,0xFE,0x11,0x74,0xF0,0xEF,0x11,0x00,0x53,0x00,0x3C,0x7E,0x11,0x11,
+    0xF1,0xFF,0x22,0xF2,0x2F,0x22,0xF2,0x2F,0x13,0xFE,0x3E,0x11,0xFF,0x07,0x77,0xB0,
+    0x03,0x00,0x7C,0x7E,0x11,0x11,0x1F,0x6B,0xF9,0x4F,0x94,0xF9,0x4F,0x93,0xF6,0x00,
+    0x3B,0xE7,0x24,0x11,0x10,0x3D,0x03,0x00,0x0E,0x3E,0x1F,0x98,0xF9,0x80,0x03,0x00,
+    0x38,0x3E,0x1F,0x98,0xF9,0x8F,0xC0,0x11,0x1F,0x7F,0x73,0x7F,0x24,0x11,0x10,0x3F,
+    0x24,0x8F,0x2D,0xA0,0x0E,0x3E,0x22,0x40,0x03,0x00,0x7F,0xB7,0x11,0x11,0x11,0x10,
+    0x30,0x30,0x30,0x3B,0xE7,0x11,0x11,0x10,0x3D,0x03,0x00,0x3C,0x7E,0x11,0x11,0xF1,
+    0xF0,0x00,0x0F,0x1F,0x1B,0x7F,0x11,0x11,0x1F,0xFF,0xFA,0x10,0x0F,0x11,0xF0,0xE0,
+    0x78,0xFE,0x11,0x11,0xF0,0xEF,0x11,0x00,0xFA,0x0F,0xFF,0x10,0x77,0x5F,0x11,0x11,
+    0x11,0x00,0x3D,0x06,0x7C,0x7E,0x11,0x11,0x1F,0x33,0xF2,0x4F,0x24,0xF2,0x4F,0x24,
+    0xF1,0x90,0x3E,0x38,0x11,0xFE,0x01,0x1F,0x1F,0x00,0x63,0xFE,0x11,0x11,0xF1,0xF0,
+    0x00,0x53,0x00,0xE7,0x7E,0x11,0x11,0x11,0x6F,0x0E,0xA2,0xF0,0x66,0xEB,0x7F,0x11,
+    0x11,0x11,0xF0,0xFA,0xF0,0xCF,0x03,0xF0,0xCA,0xF0,0xF0,0x76,0x7E,0x11,0x11,0x10,
+    0xF3,0x1F,0x2E,0xF0,0xEF,0x31,0x00,0xE7,0x7F,0x11,0x11,0x11,0x1F,0x81,0xF8,0xEF,
+    0x70,0xBF,0x06,0x60,0x7E,0x7E,0x11,0x11,0x11,0xDA,0xF2,0xCF,0x22,0xDA,0xF0,0xE0,
+    0x1F,0x7C,0x88,0x39,0x90,0x10,0x10,0xFF,0xFF,0xFF,0x1E,0x0E,0x88,0xF7,0xC1,0x99,
+    0x30,0xFE,0x00,0xF0,0x66,0x68,0x8C,0xC0,
+};
+static const uint8_t Font8x16_Metrics[95] = {
+    0x03,0x32,0x16,0x07,0x15,0x07,0x08,0x03,0x34,0x14,0x07,0x07,0x03,0x17,0x12,0x17,
+    0x16,0x16,0x16,0x16,0x16,0x16,0x16,0x16,0x16,0x16,0x32,0x22,0x16,0x07,0x16,0x16,
+    0x07,0x08,0x07,0x07,0x07,0x07,0x07,0x07,0x08,0x15,0x07,0x07,0x07,0x07,0x08,0x07,
+    0x07,0x07,0x08,0x16,0x07,0x08,0x08,0x07,0x08,0x07,0x07,0x34,0x16,0x14,0x25,0x08,
+    0x13,0x17,0x07,0x16,0x17,0x16,0x17,0x16,0x08,0x15,0x15,0x07,0x15,0x08,0x08,0x16,
+    0x07,0x17,0x07,0x16,0x15,0x08,0x08,0x08,0x16,0x08,0x16,0x44,0x41,0x14,0x17,
+};
+static const FONT_TypeDef Font8x16 = {32, 95, 8, 2, Font8x16_Dict, Font8x16_Index, Font8x16_Data, Font8x16_Metrics};
+
+#define FONT_HAS_HZK 0
+
+#endif /* __OLEDFONT_PACK_H */
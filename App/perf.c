@@ -0,0 +1,87 @@
+#include "perf.h"
+
+/**
+  * @brief  初始化DWT周期计数器
+  * @note   Cortex-M3内核自带，调试器未连接时也可使用
+  * @retval None
+  */
+void PERF_Init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+  * @brief  清空耗时统计
+  * @param  stat: 统计结构体指针
+  * @retval None
+  */
+void PERF_Reset(PERF_Stat_TypeDef *stat)
+{
+    stat->count = 0;
+    stat->min = 0xFFFFFFFF;
+    stat->max = 0;
+    stat->last = 0;
+    stat->total = 0;
+}
+
+/**
+  * @brief  记录一次耗时
+  * @param  stat: 统计结构体指针
+  * @param  cycles: 本次耗费的周期数
+  * @retval None
+  */
+void PERF_Record(PERF_Stat_TypeDef *stat, uint32_t cycles)
+{
+    if (stat->count == 0 || cycles < stat->min)
+    {
+        stat->min = cycles;
+    }
+    if (cycles > stat->max)
+    {
+        stat->max = cycles;
+    }
+    stat->last = cycles;
+    stat->total += cycles;
+    stat->count++;
+}
+
+/**
+  * @brief  获取平均周期数
+  * @param  stat: 统计结构体指针
+  * @retval 平均周期数
+  */
+uint32_t PERF_Average(const PERF_Stat_TypeDef *stat)
+{
+    if (stat->count == 0)
+    {
+        return 0;
+    }
+    return (uint32_t)(stat->total / stat->count);
+}
+
+/**
+  * @brief  周期数换算为微秒
+  * @param  cycles: 周期数
+  * @retval 微秒数
+  */
+uint32_t PERF_CyclesToUs(uint32_t cycles)
+{
+    return cycles / (SystemCoreClock / 1000000);
+}
+
+/**
+  * @brief  通过RTT打印耗时统计
+  * @param  name: 统计项名称
+  * @param  stat: 统计结构体指针
+  * @retval None
+  */
+void PERF_Print(const char *name, const PERF_Stat_TypeDef *stat)
+{
+    uint32_t avg = PERF_Average(stat);
+
+    SEGGER_RTT_printf(0, "%s: n=%u avg=%u cyc (%u us) min=%u max=%u\n",
+                      name, stat->count, avg, PERF_CyclesToUs(avg),
+                      stat->count ? stat->min : 0, stat->max);
+}
@@ -0,0 +1,26 @@
+#ifndef __PERF_H
+#define __PERF_H
+
+#include "main.h"
+
+// 读取DWT周期计数器(72MHz下约59秒回绕一次，差值计算不受影响)
+#define PERF_CYCLES()   (DWT->CYCCNT)
+
+// 耗时统计结构体
+typedef struct {
+    uint32_t count;     // 采样次数
+    uint32_t min;       // 最小周期数
+    uint32_t max;       // 最大周期数
+    uint32_t last;      // 最近一次周期数
+    uint64_t total;     // 累计周期数
+} PERF_Stat_TypeDef;
+
+// 函数声明
+void PERF_Init(void);
+void PERF_Reset(PERF_Stat_TypeDef *stat);
+void PERF_Record(PERF_Stat_TypeDef *stat, uint32_t cycles);
+uint32_t PERF_Average(const PERF_Stat_TypeDef *stat);
+uint32_t PERF_CyclesToUs(uint32_t cycles);
+void PERF_Print(const char *name, const PERF_Stat_TypeDef *stat);
+
+#endif /* __PERF_H */
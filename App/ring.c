@@ -0,0 +1,365 @@
+#include "ring.h"
+#include <string.h>
+
+/**
+  * @brief  初始化环形缓冲区
+  * @param  ring: 环形缓冲区指针
+  * @param  buf: 存储区
+  * @param  size: 存储区长度，必须为2的幂
+  * @retval None
+  */
+void RING_Init(RING_TypeDef *ring, uint8_t *buf, uint16_t size)
+{
+    ring->buf = buf;
+    ring->mask = size - 1;
+    ring->pos = 0;
+    ring->hdma = NULL;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->dropped = 0;
+}
+
+/**
+  * @brief  绑定写入本缓冲区的循环DMA
+  * @param  ring: 环形缓冲区指针
+  * @param  hdma: DMA句柄，传输长度与缓冲区长度相同
+  * @retval None
+  * @note   绑定后RING_Count按DMA剩余计数计算实时写位置，
+  *         DMA已写但还没有在中断中推进head的字节同样计入可读和覆盖判断
+  */
+void RING_AttachDMA(RING_TypeDef *ring, DMA_HandleTypeDef *hdma)
+{
+    ring->hdma = hdma;
+}
+
+/**
+  * @brief  生产者的实时累计写入字节数
+  * @param  ring: 环形缓冲区指针
+  * @retval 累计写入字节数，未绑定DMA时即head
+  * @note   head和pos在中断中一起更新，读的过程中head变化说明中断插入，重读
+  */
+static uint32_t RING_Live(RING_TypeDef *ring)
+{
+    uint32_t head;
+    uint16_t pos;
+    uint16_t cur;
+
+    if (ring->hdma == NULL)
+    {
+        return ring->head;
+    }
+
+    do
+    {
+        head = ring->head;
+        pos = ring->pos;
+        cur = (ring->mask + 1 - __HAL_DMA_GET_COUNTER(ring->hdma)) & ring->mask;
+    } while (head != ring->head);
+
+    return head + ((uint16_t)(cur - pos) & ring->mask);
+}
+
+/**
+  * @brief  生产者：外部(循环DMA)已写到pos，推进head
+  * @param  ring: 环形缓冲区指针
+  * @param  pos: 下一个将被写入的位置(长度-DMA剩余计数)
+  * @retval None
+  * @note   在DMA半满、全满和串口空闲中断中调用，相邻两次调用之间写入不超过一圈
+  */
+void RING_Produce(RING_TypeDef *ring, uint16_t pos)
+{
+    pos &= ring->mask;
+    ring->head += (uint16_t)(pos - ring->pos) & ring->mask;
+    ring->pos = pos;
+}
+
+/**
+  * @brief  生产者：软件写入数据
+  * @param  ring: 环形缓冲区指针
+  * @param  data: 数据
+  * @param  len: 长度
+  * @retval None
+  * @note   与DMA一样不检查空间，消费者来不及读时覆盖最旧的数据，由RING_Count统计丢失
+  */
+void RING_Write(RING_TypeDef *ring, const uint8_t *data, uint16_t len)
+{
+    while (len)
+    {
+        uint16_t n = ring->mask + 1 - ring->pos;
+        if (n > len)
+        {
+            n = len;
+        }
+        memcpy(ring->buf + ring->pos, data, n);
+        data += n;
+        len -= n;
+        ring->pos = (ring->pos + n) & ring->mask;
+        ring->head += n;
+    }
+}
+
+/**
+  * @brief  消费者：可读字节数
+  * @param  ring: 环形缓冲区指针
+  * @retval 可读字节数
+  * @note   未读数据达到一整圈时，生产者的下一个字节就会覆盖tail，
+  *         此时未读数据视为已损坏，全部丢弃并计入dropped
+  */
+uint32_t RING_Count(RING_TypeDef *ring)
+{
+    uint32_t live = RING_Live(ring);
+    uint32_t count = live - ring->tail;
+
+    if (count >= (uint32_t)ring->mask + 1)
+    {
+        ring->dropped += count;
+        ring->tail = live;
+        return 0;
+    }
+    return count;
+}
+
+/**
+  * @brief  消费者：取从tail开始的一段连续可读数据，不复制
+  * @param  ring: 环形缓冲区指针
+  * @param  data: 输出数据起始地址
+  * @retval 连续可读字节数，数据跨过缓冲区末尾时只返回末尾之前的部分
+  */
+uint16_t RING_Peek(RING_TypeDef *ring, const uint8_t **data)
+{
+    uint32_t count = RING_Count(ring);
+    uint16_t idx = ring->tail & ring->mask;
+    uint16_t n = ring->mask + 1 - idx;
+
+    *data = ring->buf + idx;
+    return (count < n) ? count : n;
+}
+
+/**
+  * @brief  消费者：读出(丢弃)len字节
+  * @param  ring: 环形缓冲区指针
+  * @param  len: 字节数，不超过RING_Count
+  * @retval HAL_OK: 读出的数据在处理期间完好
+  *         HAL_ERROR: 处理期间生产者已追上并覆盖了这段数据的开头，处理结果不可信，字节计入dropped
+  * @note   在处理完RING_Peek取得的数据之后调用
+  */
+HAL_StatusTypeDef RING_Skip(RING_TypeDef *ring, uint32_t len)
+{
+    uint32_t tail = ring->tail;
+
+    ring->tail = tail + len;
+    if (RING_Live(ring) - tail > (uint32_t)ring->mask + 1)
+    {
+        ring->dropped += len;
+        return HAL_ERROR;
+    }
+    return HAL_OK;
+}
+
+#ifdef RING_BENCHMARK
+#include "perf.h"
+
+#define RING_BENCH_SIZE     512
+#define RING_BENCH_BYTES    200000UL
+#define RING_BENCH_BURST    160
+static uint8_t bench_ring_buf[RING_BENCH_SIZE];
+static DMA_Channel_TypeDef bench_dma_regs;     // 模拟的DMA通道寄存器，只用到剩余计数
+static DMA_HandleTypeDef bench_dma;
+
+static void RING_BenchmarkDMA(void);
+
+/**
+  * @brief  第n个字节的测试值，消费者据此校验数据
+  * @param  n: 累计字节序号
+  * @retval 字节值
+  */
+static uint8_t RING_BenchByte(uint32_t n)
+{
+    return (uint8_t)(n ^ (n >> 8) ^ (n >> 16));
+}
+
+/**
+  * @brief  环形缓冲区突发写入压力测试，通过RTT输出吞吐和丢失情况
+  * @note   生产者按伪随机长度突发写入(1..RING_BENCH_BURST字节，偶尔连续多次突发模拟背靠背的URC)，
+  *         消费者按伪随机步长原地读取并逐字节校验；消费者落后一圈及以上时应报告丢失而不是读到错数据。
+  *         corrupt应为0，dropped与lagged(落后一圈及以上的次数)同时出现；
+  *         之后运行RING_BenchmarkDMA
+  * @retval None
+  */
+void RING_Benchmark(void)
+{
+    RING_TypeDef ring;
+    PERF_Stat_TypeDef stat;
+    uint8_t burst[RING_BENCH_BURST];
+    uint32_t seed = 12345;
+    uint32_t produced = 0, consumed = 0, corrupt = 0, lagged = 0;
+    uint32_t start;
+
+    PERF_Init();
+    PERF_Reset(&stat);
+    RING_Init(&ring, bench_ring_buf, RING_BENCH_SIZE);
+
+    while (produced < RING_BENCH_BYTES)
+    {
+        // 生产：1~4次连续突发
+        seed = seed * 1103515245 + 12345;
+        uint8_t bursts = 1 + ((seed >> 16) & 0x03);
+        for (uint8_t b = 0; b < bursts; b++)
+        {
+            seed = seed * 1103515245 + 12345;
+            uint16_t len = 1 + (seed >> 16) % RING_BENCH_BURST;
+            for (uint16_t i = 0; i < len; i++)
+            {
+                burst[i] = RING_BenchByte(produced + i);
+            }
+            RING_Write(&ring, burst, len);
+            produced += len;
+        }
+        if (ring.head - ring.tail >= RING_BENCH_SIZE)
+        {
+            lagged++;
+        }
+
+        // 消费：读取一部分或全部
+        seed = seed * 1103515245 + 12345;
+        uint32_t budget = (seed >> 16) % (2 * RING_BENCH_SIZE);
+        start = PERF_CYCLES();
+        while (budget)
+        {
+            const uint8_t *data;
+            uint16_t n = RING_Peek(&ring, &data);
+            if (n == 0)
+            {
+                break;
+            }
+            if (n > budget)
+            {
+                n = budget;
+            }
+            for (uint16_t i = 0; i < n; i++)
+            {
+                if (data[i] != RING_BenchByte(ring.tail + i))
+                {
+                    corrupt++;
+                }
+            }
+            RING_Skip(&ring, n);
+            consumed += n;
+            budget -= n;
+        }
+        PERF_Record(&stat, PERF_CYCLES() - start);
+    }
+
+    SEGGER_RTT_printf(0, "ring produced=%u consumed=%u dropped=%u corrupt=%u lagged=%u\n",
+                      produced, consumed, ring.dropped, corrupt, lagged);
+    SEGGER_RTT_printf(0, "ring consume %u cycles/byte (incl. verify)\n",
+                      (uint32_t)(stat.total / (consumed ? consumed : 1)));
+    PERF_Print("ring consume", &stat);
+
+    RING_BenchmarkDMA();
+}
+
+/**
+  * @brief  模拟循环DMA写入len字节
+  * @param  ring: 环形缓冲区指针
+  * @param  written: 累计写入字节数
+  * @param  len: 字节数
+  * @param  idle: 非0时写完后像串口空闲中断一样推进head
+  * @retval None
+  * @note   每写一个字节剩余计数减1，到0重装；越过半满、全满位置时像DMA回调一样推进head，
+  *         其余时候DMA都写在head之前
+  */
+static void RING_BenchDMA(RING_TypeDef *ring, uint32_t *written, uint16_t len, uint8_t idle)
+{
+    while (len--)
+    {
+        ring->buf[RING_BENCH_SIZE - bench_dma_regs.CNDTR] = RING_BenchByte((*written)++);
+        if (--bench_dma_regs.CNDTR == 0)
+        {
+            bench_dma_regs.CNDTR = RING_BENCH_SIZE;
+        }
+        if (bench_dma_regs.CNDTR == RING_BENCH_SIZE || bench_dma_regs.CNDTR == RING_BENCH_SIZE / 2)
+        {
+            RING_Produce(ring, RING_BENCH_SIZE - bench_dma_regs.CNDTR);
+        }
+    }
+    if (idle)
+    {
+        RING_Produce(ring, RING_BENCH_SIZE - bench_dma_regs.CNDTR);
+    }
+}
+
+/**
+  * @brief  循环DMA写入的覆盖测试，通过RTT输出结果
+  * @note   DMA按伪随机长度写入，只在半满/全满和偶尔的空闲中断推进head；
+  *         消费者Peek之后、校验之前DMA继续写入(模拟分帧处理期间收到数据)，偶尔超过一圈。
+  *         RING_Skip返回HAL_OK的数据corrupt应为0，处理期间被追上的数据计入lapped；
+  *         produced = consumed + dropped + 未读
+  * @retval None
+  */
+static void RING_BenchmarkDMA(void)
+{
+    RING_TypeDef ring;
+    uint32_t seed = 54321;
+    uint32_t produced = 0, consumed = 0, corrupt = 0, lapped = 0;
+    uint32_t unread;
+
+    bench_dma.Instance = &bench_dma_regs;
+    bench_dma_regs.CNDTR = RING_BENCH_SIZE;
+    RING_Init(&ring, bench_ring_buf, RING_BENCH_SIZE);
+    RING_AttachDMA(&ring, &bench_dma);
+
+    while (produced < RING_BENCH_BYTES)
+    {
+        // 接收：最多约一圈半，四分之一的情况以空闲中断结束
+        seed = seed * 1103515245 + 12345;
+        RING_BenchDMA(&ring, &produced, (seed >> 16) % (RING_BENCH_SIZE + RING_BENCH_SIZE / 2),
+                      (seed & 0x3000) == 0);
+
+        // 处理：Peek之后DMA继续写入，八分之一的情况写入一圈左右
+        seed = seed * 1103515245 + 12345;
+        uint32_t budget = (seed >> 16) % (2 * RING_BENCH_SIZE);
+        while (budget)
+        {
+            const uint8_t *data;
+            uint32_t bad = 0;
+            uint16_t n = RING_Peek(&ring, &data);
+            if (n == 0)
+            {
+                break;
+            }
+            if (n > budget)
+            {
+                n = budget;
+            }
+
+            seed = seed * 1103515245 + 12345;
+            RING_BenchDMA(&ring, &produced,
+                          ((seed >> 16) & 0x07) == 0 ? (seed >> 19) % (RING_BENCH_SIZE + RING_BENCH_SIZE / 4)
+                                                      : (seed >> 19) % 32, 0);
+
+            for (uint16_t i = 0; i < n; i++)
+            {
+                if (data[i] != RING_BenchByte(ring.tail + i))
+                {
+                    bad++;
+                }
+            }
+            if (RING_Skip(&ring, n) == HAL_OK)
+            {
+                corrupt += bad;
+                consumed += n;
+            }
+            else
+            {
+                lapped++;
+            }
+            budget -= n;
+        }
+    }
+
+    unread = RING_Count(&ring);
+    SEGGER_RTT_printf(0, "ring dma produced=%u consumed=%u dropped=%u unread=%u corrupt=%u lapped=%u\n",
+                      produced, consumed, ring.dropped, unread, corrupt, lapped);
+}
+#endif
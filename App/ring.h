@@ -0,0 +1,33 @@
+#ifndef __RING_H
+#define __RING_H
+
+#include "main.h"
+
+// 单生产者/单消费者字节环形缓冲区
+// 生产者(DMA或中断)只改head，消费者(主循环)只改tail，两边都不需要关中断；
+// head/tail为累计字节数，自然溢出，下标取低位，因此长度必须为2的幂；
+// 由循环DMA写入时，head只在半满/全满/空闲中断推进，DMA实际已写到head之后，
+// 绑定DMA句柄后消费者从DMA剩余计数读出实时写位置，据此判断覆盖
+typedef struct {
+    uint8_t *buf;               // 存储区
+    uint16_t mask;              // 长度-1
+    volatile uint16_t pos;      // 生产者上次看到的写位置(0..长度-1)
+    DMA_HandleTypeDef *hdma;    // 写入本缓冲区的循环DMA，NULL表示只由软件写入
+    volatile uint32_t head;     // 累计写入字节数(生产者)
+    volatile uint32_t tail;     // 累计读出字节数(消费者)
+    uint32_t dropped;           // 被覆盖丢弃的字节数(消费者)
+} RING_TypeDef;
+
+// 函数声明
+void RING_Init(RING_TypeDef *ring, uint8_t *buf, uint16_t size);
+void RING_AttachDMA(RING_TypeDef *ring, DMA_HandleTypeDef *hdma);
+void RING_Produce(RING_TypeDef *ring, uint16_t pos);
+void RING_Write(RING_TypeDef *ring, const uint8_t *data, uint16_t len);
+uint32_t RING_Count(RING_TypeDef *ring);
+uint16_t RING_Peek(RING_TypeDef *ring, const uint8_t **data);
+HAL_StatusTypeDef RING_Skip(RING_TypeDef *ring, uint32_t len);
+#ifdef RING_BENCHMARK
+void RING_Benchmark(void);
+#endif
+
+#endif /* __RING_H */
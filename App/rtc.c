@@ -142,4 +142,5 @@ void RTC_DisplayTime(RTC_TimeTypeDef *time, uint8_t x, uint8_t y)
     OLED_ShowString(x, y, dateStr, 16);           // 显示日期
     OLED_ShowString(x, y + 2, timeStr, 16);       // 显示时间
     OLED_ShowString(x, y + 4, weekStr, 16);       // 显示星期
+    OLED_Refresh();
 }
\ No newline at end of file
@@ -0,0 +1,402 @@
+#include "scene.h"
+#include "oled.h"
+#include <string.h>
+
+// 内置图标(8x16)，索引见SCENE_ICON_xxx
+static const uint8_t SCENE_Icons[][SCENE_ICON_WIDTH * 2] = {
+    {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00}, // 空白
+    {0x00,0x00,0x00,0x00,0xC0,0x00,0xF8,0x00,0x30,0x00,0x3E,0x00,0x3F,0x00,0x3F,0x00}, // 信号格
+    {0x00,0x00,0x00,0x00,0x28,0x10,0x28,0x00,0x30,0x00,0x00,0x00,0x00,0x00,0x00,0x00}, // 无信号
+    {0x80,0x60,0x18,0xE6,0xE6,0x18,0x60,0x80,0x0F,0x08,0x08,0x0D,0x0D,0x08,0x08,0x0F}  // 报警
+};
+
+#define SCENE_ICON_COUNT  (sizeof(SCENE_Icons) / sizeof(SCENE_Icons[0]))
+
+/**
+  * @brief  初始化场景
+  * @param  scene: 场景指针
+  * @param  widgets: 控件数组，各控件需另外用SCENE_InitXxx初始化
+  * @param  count: 控件个数
+  * @retval None
+  */
+void SCENE_Init(SCENE_TypeDef *scene, SCENE_Widget_TypeDef *widgets, uint8_t count)
+{
+    scene->widgets = widgets;
+    scene->count = count;
+    scene->clear_count = OLED_GetClearCount() - 1; // 保证首次绘制时整体重绘
+}
+
+/**
+  * @brief  开始更新一个场景，屏幕被清空或被其他界面占用过时让全部控件整体重绘
+  * @param  scene: 场景指针
+  * @retval None
+  */
+void SCENE_Begin(SCENE_TypeDef *scene)
+{
+    uint16_t clear_count = OLED_GetClearCount();
+    
+    if (scene->clear_count != clear_count)
+    {
+        scene->clear_count = clear_count;
+        SCENE_Invalidate(scene);
+    }
+}
+
+/**
+  * @brief  标记场景内全部控件需要重绘
+  * @param  scene: 场景指针
+  * @retval None
+  */
+void SCENE_Invalidate(SCENE_TypeDef *scene)
+{
+    for (uint8_t i = 0; i < scene->count; i++)
+    {
+        scene->widgets[i].valid = 0;
+    }
+}
+
+/**
+  * @brief  初始化文本控件
+  * @param  w: 控件指针
+  * @param  x: 区域起始列
+  * @param  page: 起始页
+  * @param  width: 区域宽度(列)
+  * @param  size: 字体大小(8/16)
+  * @retval None
+  */
+void SCENE_InitLabel(SCENE_Widget_TypeDef *w, uint8_t x, uint8_t page, uint8_t width, uint8_t size)
+{
+    memset(w, 0, sizeof(SCENE_Widget_TypeDef));
+    w->type = SCENE_LABEL;
+    w->x = x;
+    w->page = page;
+    w->u.label.width = (width > OLED_WIDTH - x) ? OLED_WIDTH - x : width;
+    w->u.label.size = size;
+}
+
+/**
+  * @brief  初始化条形图控件
+  * @param  w: 控件指针
+  * @param  x: 起始列
+  * @param  page: 起始页(占page和page+1两页)
+  * @param  width: 总列数(含两端边框)，宽度为102时每1%对应一列
+  * @retval None
+  */
+void SCENE_InitBar(SCENE_Widget_TypeDef *w, uint8_t x, uint8_t page, uint8_t width)
+{
+    memset(w, 0, sizeof(SCENE_Widget_TypeDef));
+    w->type = SCENE_BAR;
+    w->x = x;
+    w->page = page;
+    w->u.bar.width = width;
+}
+
+/**
+  * @brief  初始化图标控件
+  * @param  w: 控件指针
+  * @param  x: 起始列
+  * @param  page: 起始页(占page和page+1两页)
+  * @retval None
+  */
+void SCENE_InitIcon(SCENE_Widget_TypeDef *w, uint8_t x, uint8_t page)
+{
+    memset(w, 0, sizeof(SCENE_Widget_TypeDef));
+    w->type = SCENE_ICON;
+    w->x = x;
+    w->page = page;
+}
+
+/**
+  * @brief  初始化历史曲线控件
+  * @param  w: 控件指针
+  * @param  x: 起始列
+  * @param  page: 起始页
+  * @param  width: 列数，不超过HISTORY_SIZE
+  * @param  pages: 高度(页数)
+  * @retval None
+  */
+void SCENE_InitGraph(SCENE_Widget_TypeDef *w, uint8_t x, uint8_t page, uint8_t width, uint8_t pages)
+{
+    memset(w, 0, sizeof(SCENE_Widget_TypeDef));
+    w->type = SCENE_GRAPH;
+    w->x = x;
+    w->page = page;
+    w->u.graph.width = (width > HISTORY_SIZE) ? HISTORY_SIZE : width;
+    w->u.graph.pages = pages;
+}
+
+/**
+  * @brief  判断新旧文本能否只重绘变化的字符
+  * @param  w: 控件指针
+  * @param  text: 新文本
+  * @param  len: 新文本长度
+  * @retval 1:长度相同且每个位置的字符宽度都相同(如只有数字变化) 0:需要整体重绘
+  */
+static uint8_t SCENE_SameLayout(SCENE_Widget_TypeDef *w, const char *text, uint8_t len)
+{
+    if (!w->valid || len != w->u.label.len)
+    {
+        return 0;
+    }
+    for (uint8_t i = 0; i < len; i++)
+    {
+        if (text[i] != w->u.label.text[i] &&
+            OLED_CharAdvance(text[i], w->u.label.size) != OLED_CharAdvance(w->u.label.text[i], w->u.label.size))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+  * @brief  设置文本控件内容
+  * @param  w: 控件指针
+  * @param  text: 文本，超出区域宽度的部分被裁掉
+  * @retval None
+  * @note   按OLED_MeasureText实测宽度居中；字符宽度布局不变时只重绘变化的字符
+  *         (数字等宽，秒数跳动只重绘1~2个字符)，否则清空区域后整体重绘
+  */
+void SCENE_SetText(SCENE_Widget_TypeDef *w, const char *text)
+{
+    static const uint8_t blank[OLED_WIDTH] = {0};
+    char clipped[SCENE_LABEL_MAX + 1];
+    uint8_t size = w->u.label.size;
+    uint8_t rows = (size == 16) ? 2 : 1;    // 占用页数
+    uint8_t width = w->u.label.width;
+    uint8_t len = strlen(text);
+    uint16_t text_width;
+    uint8_t offset;
+    
+    if (len > SCENE_LABEL_MAX)
+    {
+        len = SCENE_LABEL_MAX;
+    }
+    memcpy(clipped, text, len);
+    clipped[len] = '\0';
+    text = clipped;
+    
+    text_width = OLED_MeasureText(text, size);
+    offset = (text_width >= width) ? 0 : (width - text_width) / 2;
+    
+    if (SCENE_SameLayout(w, text, len) && offset == w->u.label.offset)
+    {
+        uint8_t cx = w->x + offset;
+        
+        for (uint8_t i = 0; i < len; i++)
+        {
+            uint8_t adv = OLED_CharAdvance(text[i], size);
+            
+            if (text[i] != w->u.label.text[i] && cx < w->x + width)
+            {
+                char one[2] = {text[i], '\0'};
+                OLED_ShowText(cx, w->page, one, size, w->x + width - cx);
+            }
+            cx += adv;
+        }
+    }
+    else
+    {
+        for (uint8_t r = 0; r < rows; r++)
+        {
+            OLED_DrawBitmap(w->x, w->page + r, blank, width);
+        }
+        OLED_ShowText(w->x + offset, w->page, text, size, width - offset);
+    }
+    
+    memcpy(w->u.label.text, text, len + 1);
+    w->u.label.len = len;
+    w->u.label.offset = offset;
+    w->valid = 1;
+}
+
+/**
+  * @brief  绘制条形图的[from, to)列
+  * @param  w: 控件指针
+  * @param  from: 起始列(相对控件)
+  * @param  to: 结束列(相对控件，不含)
+  * @retval None
+  * @note   两端为实心边框；内部上下各一条边线，填充部分与边线之间留1像素间隙
+  */
+static void SCENE_DrawBar(SCENE_Widget_TypeDef *w, uint8_t from, uint8_t to)
+{
+    uint8_t upper[OLED_WIDTH];
+    uint8_t lower[OLED_WIDTH];
+    uint8_t last = w->u.bar.width - 1;
+    
+    for (uint8_t i = from; i < to; i++)
+    {
+        if (i == 0 || i == last)
+        {
+            upper[i - from] = 0xFF;
+            lower[i - from] = 0xFF;
+        }
+        else if (i <= w->u.bar.fill)
+        {
+            upper[i - from] = 0xFD;
+            lower[i - from] = 0xBF;
+        }
+        else
+        {
+            upper[i - from] = 0x01;
+            lower[i - from] = 0x80;
+        }
+    }
+    
+    OLED_DrawBitmap(w->x + from, w->page, upper, to - from);
+    OLED_DrawBitmap(w->x + from, w->page + 1, lower, to - from);
+}
+
+/**
+  * @brief  设置条形图百分比或图标索引
+  * @param  w: 控件指针
+  * @param  value: 条形图为0-100，图标为SCENE_ICON_xxx
+  * @retval None
+  * @note   条形图只重绘新旧填充边界之间的列
+  */
+void SCENE_SetValue(SCENE_Widget_TypeDef *w, uint8_t value)
+{
+    if (w->type == SCENE_BAR)
+    {
+        uint8_t old = w->u.bar.fill;
+        uint8_t fill;
+        
+        if (value > 100)
+        {
+            value = 100;
+        }
+        fill = (uint16_t)value * (w->u.bar.width - 2) / 100;
+        
+        w->u.bar.fill = fill;
+        if (!w->valid)
+        {
+            SCENE_DrawBar(w, 0, w->u.bar.width);
+        }
+        else if (fill > old)
+        {
+            SCENE_DrawBar(w, old + 1, fill + 1);
+        }
+        else if (fill < old)
+        {
+            SCENE_DrawBar(w, fill + 1, old + 1);
+        }
+        w->valid = 1;
+    }
+    else if (w->type == SCENE_ICON)
+    {
+        if (value >= SCENE_ICON_COUNT || (w->valid && value == w->u.icon.index))
+        {
+            return;
+        }
+        
+        OLED_DrawBitmap(w->x, w->page, SCENE_Icons[value], SCENE_ICON_WIDTH);
+        OLED_DrawBitmap(w->x, w->page + 1, &SCENE_Icons[value][SCENE_ICON_WIDTH], SCENE_ICON_WIDTH);
+        w->u.icon.index = value;
+        w->valid = 1;
+    }
+}
+
+/**
+  * @brief  把水位(%)换算为曲线内的像素行，0%在最下面
+  * @param  w: 控件指针
+  * @param  level: 水位(%)
+  * @retval 相对控件顶部的像素行
+  */
+static uint8_t SCENE_GraphRow(SCENE_Widget_TypeDef *w, uint8_t level)
+{
+    uint8_t height = w->u.graph.pages * 8;
+    
+    if (level > 100)
+    {
+        level = 100;
+    }
+    return (uint16_t)(100 - level) * (height - 1) / 100;
+}
+
+/**
+  * @brief  绘制曲线的[from, width)列
+  * @param  w: 控件指针
+  * @param  from: 起始列(相对控件)
+  * @retval None
+  * @note   每列画出该桶最小值到最大值的竖线，并延伸到与前一桶相接，使曲线连续
+  */
+static void SCENE_DrawGraph(SCENE_Widget_TypeDef *w, uint8_t from)
+{
+    uint8_t top[HISTORY_SIZE];      // 各列竖线的起止像素行，top > bottom表示该列留空
+    uint8_t bottom[HISTORY_SIZE];
+    uint8_t row[HISTORY_SIZE];
+    uint8_t width = w->u.graph.width;
+    uint8_t n = width - from;
+    
+    for (uint8_t c = 0; c < n; c++)
+    {
+        uint16_t age = width - 1 - from - c;
+        uint8_t lo, hi, prev_lo, prev_hi;
+        
+        top[c] = 0xFF;
+        bottom[c] = 0;
+        if (!HISTORY_Get(w->u.graph.history, age, &lo, &hi))
+        {
+            continue; // 还没有数据的列留空
+        }
+        if (HISTORY_Get(w->u.graph.history, age + 1, &prev_lo, &prev_hi))
+        {
+            if (prev_hi < lo)
+            {
+                lo = prev_hi;
+            }
+            if (prev_lo > hi)
+            {
+                hi = prev_lo;
+            }
+        }
+        top[c] = SCENE_GraphRow(w, hi);
+        bottom[c] = SCENE_GraphRow(w, lo);
+    }
+    
+    for (uint8_t p = 0; p < w->u.graph.pages; p++)
+    {
+        uint8_t y0 = p * 8;
+        
+        for (uint8_t c = 0; c < n; c++)
+        {
+            row[c] = 0;
+            for (uint8_t bit = 0; bit < 8; bit++)
+            {
+                if (y0 + bit >= top[c] && y0 + bit <= bottom[c])
+                {
+                    row[c] |= 1 << bit;
+                }
+            }
+        }
+        OLED_DrawBitmap(w->x + from, w->page + p, row, n);
+    }
+}
+
+/**
+  * @brief  用历史数据更新曲线
+  * @param  w: 控件指针
+  * @param  history: 要显示的历史
+  * @retval None
+  * @note   自上次绘制以来新增n个桶时，已有曲线左移n列，只补画最右n列；
+  *         首次绘制、更换历史或新增桶数不少于宽度时整体重绘
+  */
+void SCENE_SetHistory(SCENE_Widget_TypeDef *w, const HISTORY_TypeDef *history)
+{
+    uint32_t added = history->total - w->u.graph.total;
+    uint8_t width = w->u.graph.width;
+    
+    if (!w->valid || history != w->u.graph.history || added >= width)
+    {
+        w->u.graph.history = history;
+        SCENE_DrawGraph(w, 0);
+    }
+    else if (added > 0)
+    {
+        OLED_ScrollLeft(w->x, w->page, width, w->u.graph.pages, added);
+        SCENE_DrawGraph(w, width - added);
+    }
+    
+    w->u.graph.total = history->total;
+    w->valid = 1;
+}
@@ -0,0 +1,76 @@
+#ifndef __SCENE_H
+#define __SCENE_H
+
+#include "main.h"
+#include "history.h"
+
+// 文本控件最多保存的字符数(比例宽度下一行约可显示20个字符)
+#define SCENE_LABEL_MAX     24
+
+// 图标尺寸：8列x16行，与8x16字模相同的存放方式(上半页8字节，下半页8字节)
+#define SCENE_ICON_WIDTH    8
+
+// 内置图标索引
+#define SCENE_ICON_BLANK      0
+#define SCENE_ICON_SIGNAL     1   // 4G已连接
+#define SCENE_ICON_NO_SIGNAL  2   // 4G未连接
+#define SCENE_ICON_ALARM      3   // 报警
+
+// 控件类型
+typedef enum {
+    SCENE_LABEL,        // 文本(比例宽度)，在固定宽度的区域内按实测宽度居中
+    SCENE_BAR,          // 水平条形图，占两页
+    SCENE_ICON,         // 8x16图标
+    SCENE_GRAPH         // 水位历史曲线，每列一个历史桶
+} SCENE_Type_TypeDef;
+
+// 控件：保存上次绘制的内容，值不变时不重绘
+typedef struct {
+    SCENE_Type_TypeDef type;
+    uint8_t x;                  // 起始列
+    uint8_t page;               // 起始页
+    uint8_t valid;              // 0:屏幕上的内容未知，下次设置值时整体重绘
+    union {
+        struct {
+            uint8_t width;      // 区域宽度(列)
+            uint8_t size;       // 字体大小(8/16)
+            uint8_t len;        // 当前文本长度(字符数)
+            uint8_t offset;     // 当前文本相对区域起点的列偏移
+            char text[SCENE_LABEL_MAX + 1];
+        } label;
+        struct {
+            uint8_t width;      // 总列数(含两端边框)
+            uint8_t fill;       // 当前填充列数
+        } bar;
+        struct {
+            uint8_t index;      // 当前图标
+        } icon;
+        struct {
+            uint8_t width;      // 列数(最右列为最近的桶)
+            uint8_t pages;      // 高度(页数)
+            const HISTORY_TypeDef *history; // 当前显示的历史
+            uint32_t total;     // 上次绘制时历史已结束的桶数
+        } graph;
+    } u;
+} SCENE_Widget_TypeDef;
+
+// 场景：一个页面的全部控件
+typedef struct {
+    SCENE_Widget_TypeDef *widgets;
+    uint8_t count;
+    uint16_t clear_count;       // 上次绘制时OLED_GetClearCount的值
+} SCENE_TypeDef;
+
+// 函数声明
+void SCENE_Init(SCENE_TypeDef *scene, SCENE_Widget_TypeDef *widgets, uint8_t count);
+void SCENE_Begin(SCENE_TypeDef *scene);
+void SCENE_Invalidate(SCENE_TypeDef *scene);
+void SCENE_InitLabel(SCENE_Widget_TypeDef *w, uint8_t x, uint8_t page, uint8_t width, uint8_t size);
+void SCENE_InitBar(SCENE_Widget_TypeDef *w, uint8_t x, uint8_t page, uint8_t width);
+void SCENE_InitIcon(SCENE_Widget_TypeDef *w, uint8_t x, uint8_t page);
+void SCENE_InitGraph(SCENE_Widget_TypeDef *w, uint8_t x, uint8_t page, uint8_t width, uint8_t pages);
+void SCENE_SetText(SCENE_Widget_TypeDef *w, const char *text);
+void SCENE_SetValue(SCENE_Widget_TypeDef *w, uint8_t value);
+void SCENE_SetHistory(SCENE_Widget_TypeDef *w, const HISTORY_TypeDef *history);
+
+#endif /* __SCENE_H */
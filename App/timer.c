@@ -4,7 +4,6 @@
 // 添加全局状态变量
 uint8_t g4_connected = 0;
 uint8_t g4_upload_flag = 0;
-uint8_t print_adc_value_flag = 0;
 
 // 1ms中断计数器
 static volatile uint16_t timer_counter_1s = 0;
@@ -75,8 +74,6 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
                 high_count = 0;
                 g4_connected = 0;
             }
-
-            print_adc_value_flag = 1;
         }
 
         // 20s定时器标志
@@ -7,7 +7,6 @@
 // 添加全局状态变量
 extern uint8_t g4_connected;
 extern uint8_t g4_upload_flag;
-extern uint8_t print_adc_value_flag;
 // 声明1s定时标志
 extern volatile uint8_t timer_1s_flag;
 // 声明系统毫秒计数器
@@ -0,0 +1,128 @@
+#include "trend.h"
+#include <string.h>
+
+/**
+  * @brief  初始化趋势估计器
+  * @param  tr: 估计器指针
+  * @retval None
+  */
+void TREND_Init(TREND_TypeDef *tr)
+{
+    memset(tr, 0, sizeof(TREND_TypeDef));
+}
+
+/**
+  * @brief  把时间基准后移到d，各求和项按相对时间的平移公式修正
+  * @param  tr: 估计器指针
+  * @param  d: 基准后移量(ms)
+  * @retval None
+  * @note   Σ(t-d)² = Σt² - 2dΣt + nd²，Σ(t-d)y = Σty - dΣy，Σ(t-d) = Σt - nd
+  */
+static void TREND_Rebase(TREND_TypeDef *tr, uint32_t d)
+{
+    int64_t n = tr->count;
+
+    tr->stt += -2 * (int64_t)d * tr->st + n * d * d;
+    tr->sty -= (int64_t)d * tr->sy;
+    tr->st -= n * d;
+    tr->base += d;
+}
+
+/**
+  * @brief  加入一个带时间戳的样本，窗口满时同时移出最旧样本
+  * @param  tr: 估计器指针
+  * @param  t_ms: 样本时间(ms)，必须不早于上一个样本
+  * @param  y: 样本值(Q16)
+  * @retval None
+  * @note   O(1)：只增减一个样本的求和项，并把时间基准移到新的最旧样本
+  */
+void TREND_Push(TREND_TypeDef *tr, uint32_t t_ms, int32_t y)
+{
+    int64_t dt;
+
+    if (tr->count == 0)
+    {
+        tr->base = t_ms;
+    }
+    else if (tr->count == TREND_SIZE)
+    {
+        // 移出最旧样本(即将被覆盖的位置)
+        uint16_t next = (tr->head + 1) % TREND_SIZE;
+
+        dt = tr->t[tr->head] - tr->base;
+        tr->st -= dt;
+        tr->sy -= tr->y[tr->head];
+        tr->stt -= dt * dt;
+        tr->sty -= dt * tr->y[tr->head];
+        tr->count--;
+
+        // 最旧样本变为下一个，相对时间保持在窗口跨度以内
+        TREND_Rebase(tr, tr->t[next] - tr->base);
+    }
+
+    tr->t[tr->head] = t_ms;
+    tr->y[tr->head] = y;
+    tr->head = (tr->head + 1) % TREND_SIZE;
+    tr->count++;
+
+    dt = t_ms - tr->base;
+    tr->st += dt;
+    tr->sy += y;
+    tr->stt += dt * dt;
+    tr->sty += dt * y;
+}
+
+/**
+  * @brief  最小二乘拟合斜率
+  * @param  tr: 估计器指针
+  * @retval 变化速率(Q16单位/秒)，样本不足或时间跨度为0时返回0
+  * @note   b = (nΣty - ΣtΣy) / (nΣt² - (Σt)²)，单位为每毫秒，乘1000换算为每秒
+  */
+int32_t TREND_Rate(const TREND_TypeDef *tr)
+{
+    int64_t n = tr->count;
+    int64_t num, den;
+
+    if (n < TREND_MIN_POINTS)
+    {
+        return 0;
+    }
+
+    den = n * tr->stt - tr->st * tr->st;
+    if (den <= 0)
+    {
+        return 0;
+    }
+    num = n * tr->sty - tr->st * tr->sy;
+
+    return (int32_t)(num * 1000 / den);
+}
+
+/**
+  * @brief  按当前速率预测到达目标值的时间
+  * @param  tr: 估计器指针
+  * @param  target: 目标值(Q16)
+  * @retval 剩余秒数，已到达返回0，不上升或样本不足返回TREND_NEVER
+  */
+uint32_t TREND_TimeTo(const TREND_TypeDef *tr, int32_t target)
+{
+    int32_t rate = TREND_Rate(tr);
+    int32_t last;
+
+    if (tr->count == 0)
+    {
+        return TREND_NEVER;
+    }
+
+    last = tr->y[(tr->head + TREND_SIZE - 1) % TREND_SIZE];
+    if (last >= target)
+    {
+        return 0;
+    }
+    if (rate <= 0)
+    {
+        return TREND_NEVER;
+    }
+
+    return (uint32_t)(target - last) / (uint32_t)rate;
+}
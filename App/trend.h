@@ -0,0 +1,34 @@
+#ifndef __TREND_H
+#define __TREND_H
+
+#include "main.h"
+
+// 趋势窗口长度(样本数)
+#define TREND_SIZE          32
+
+// 参与拟合的最少样本数，不足时不给出速率
+#define TREND_MIN_POINTS    8
+
+// 不会到达目标时TREND_TimeTo的返回值
+#define TREND_NEVER         0xFFFFFFFF
+
+// 带时间戳的最小二乘趋势估计器
+typedef struct {
+    uint32_t t[TREND_SIZE];     // 样本时间(ms)，按时间顺序环形存放
+    int32_t y[TREND_SIZE];      // 样本值(Q16)
+    uint16_t head;              // 下一个写入位置
+    uint16_t count;             // 窗口内样本数
+    uint32_t base;              // 时间基准(ms)，即最旧样本时间，求和使用相对时间
+    int64_t st;                 // Σt
+    int64_t sy;                 // Σy
+    int64_t stt;                // Σt²
+    int64_t sty;                // Σt·y
+} TREND_TypeDef;
+
+// 函数声明
+void TREND_Init(TREND_TypeDef *tr);
+void TREND_Push(TREND_TypeDef *tr, uint32_t t_ms, int32_t y);
+int32_t TREND_Rate(const TREND_TypeDef *tr);
+uint32_t TREND_TimeTo(const TREND_TypeDef *tr, int32_t target);
+
+#endif /* __TREND_H */
@@ -1,27 +1,135 @@
 #include "water.h"
 #include "4G.h"
 #include "timer.h"
+#include "perf.h"
+#include "window.h"
+#include "calib.h"
 #include <string.h>
 #include <stdio.h>
 
-// 定义ADC采样缓冲区
-static uint16_t adc_buffer[ADC_BUFFER_SIZE];
-static volatile uint8_t data_ready_flag = 0;
-static uint16_t adc_filtered_value = 0;
-static uint8_t water_level = 0;
-static uint8_t previous_water_level = 0;
+// 定义ADC采样缓冲区(前后两半乒乓使用)
+static uint16_t adc_buffer[ADC_DMA_BUFFER_SIZE];
+static volatile int8_t adc_ready_half = -1;     // 待处理的半区，-1表示无
+static volatile uint32_t adc_half_seq = 0;      // 半区填满次数，用于检测处理期间DMA是否追上
+static volatile uint32_t adc_overrun_count = 0; // 主循环落后导致丢弃的半区数
+static uint16_t adc_sample_rate = 0;            // 当前采样率(Hz)，连续模式下为0
+
+// 自适应采样状态
+static uint8_t adapt_level = 0;                 // 当前采样率档位，0为全速
+static uint16_t adapt_stable_blocks = 0;        // 连续未超出死区的半区数
+static uint16_t adapt_ref[WATER_CHANNELS];      // 各通道死区参考值(滤波后的ADC值)
+static uint32_t adapt_level_tick = 0;           // 进入当前档位的时刻(ms)
+static uint32_t adapt_dwell_ms[WATER_ADAPT_LEVELS]; // 各档位累计停留时间(ms)
+static uint32_t adapt_switch_count = 0;         // 档位切换次数
+
+// 每个水位通道独立的滤波状态、标定与报警状态
+typedef struct {
+    // 水位滤波流水线：去尖峰(中位数/分位数) -> 平滑 -> 标定 -> 回差量化
+    FILTER_Pipeline_TypeDef filter;
+#if WATER_FILTER_MODE == WATER_FILTER_STREAM
+    WINDOW_TypeDef window;                      // 滑动窗口分位数滤波器
+#endif
+    int32_t buffer[ADC_BUFFER_SIZE / WATER_OVERSAMPLE]; // 解交错、抽取后的Q16样本
+    uint16_t filtered_value;                    // 平滑级输出，即滤波后的ADC值
+    uint8_t level;                              // 当前水位百分比
+    
+    // 上涨趋势
+    TREND_TypeDef trend;                        // 标定后水位的时间序列
+    int32_t rise_rate;                          // 上涨速率(Q16 %/秒)
+    uint32_t time_to_threshold;                 // 预计到达阈值的秒数，TREND_NEVER表示不会到达
+    uint8_t rise_warning;                       // 预计到达时间短于提前量
+    HISTORY_TypeDef history;                    // 最近1小时水位(每桶最小/最大值)
+    
+    // 报警状态，看门狗模式下由ADC中断置为PENDING
+    volatile WaterAlarm_TypeDef alarm_state;
+    uint32_t alarm_pending_tick;                // 进入PENDING的时刻(ms)
+    uint32_t alarm_confirm_ms;                  // 本次等待滤波确认的最长时间(ms)
+    uint16_t alarm_adc_threshold;               // 达到水位阈值的ADC值，超过即报警
+    uint32_t alarm_false_count;                 // 滤波未确认的报警次数
+} WaterChannel_TypeDef;
+
+static WaterChannel_TypeDef water_ch[WATER_CHANNELS];
+static uint8_t water_smooth_stage = 0;          // 平滑级序号，各通道相同
+static uint8_t water_calib_stage = 0;           // 标定级序号，其输出为回差量化前的水位(Q16)
+static uint32_t trend_tick = 0;                 // 上次采集趋势样本的时刻(ms)
+static uint8_t display_channel = 0;             // 水位页面显示的通道
+
+// 各水位通道对应的ADC通道
+static const uint32_t water_adc_channels[FLASH_PARAM_CHANNELS] = WATER_ADC_CHANNELS;
+
+// ADC处理开销统计(每次WATER_ReportPerf后清零)
+static PERF_Stat_TypeDef adc_irq_perf;          // DMA中断耗时
+static PERF_Stat_TypeDef adc_proc_perf;         // 半区处理耗时
 
 // 页面管理相关变量
 static DisplayPage_TypeDef current_page = PAGE_WATER;
 static uint32_t page_timer = 0;
 static uint8_t page_lock = 0;  // 锁定标志，1表示锁定在水位页面
 static uint8_t water_stable_counter = 0; // 水位稳定计数器
+static OLED_Transition_TypeDef page_transition = OLED_TRANS_NONE; // 切换页面后换入新页面的方式
+
+// 页面控件：保留上次绘制的内容，只重绘值有变化的控件
+enum {
+    WATER_W_ALARM = 0,  // 报警图标
+    WATER_W_TITLE,      // 标题
+    WATER_W_4G,         // 4G状态图标
+    WATER_W_VALUE,      // 水位与阈值
+    WATER_W_BAR,        // 水位条形图
+    WATER_W_STATUS,     // 报警/预警信息
+    WATER_W_COUNT
+};
+enum {
+    HISTORY_W_TITLE = 0,    // 标题和当前水位
+    HISTORY_W_GRAPH,        // 历史曲线
+    HISTORY_W_COUNT
+};
+enum {
+    TIME_W_DATE = 0,
+    TIME_W_TIME,
+    TIME_W_CITY,
+    TIME_W_WEATHER,
+    TIME_W_COUNT
+};
+static SCENE_Widget_TypeDef water_widgets[WATER_W_COUNT];
+static SCENE_Widget_TypeDef time_widgets[TIME_W_COUNT];
+static SCENE_TypeDef water_scene;
+static SCENE_TypeDef time_scene;
+static SCENE_Widget_TypeDef history_widgets[HISTORY_W_COUNT];
+static SCENE_TypeDef history_scene;
+
+// 模拟看门狗：各通道共用一个上限，取已布防通道中最低的报警ADC值
+static volatile uint8_t alarm_event = 0;        // 看门狗报警事件(按通道置位)，主循环处理后清零
+static volatile uint8_t alarm_spurious = 0;     // 共用上限被未达自身阈值的通道触发，需重新打开中断
+static volatile uint32_t alarm_irq_entry = 0;   // 最近一次ADC中断进入时刻(DWT周期)
+static volatile uint32_t alarm_irq_stamp = 0;   // 触发报警的中断进入时刻
+static uint16_t alarm_watchdog_high = 4095;     // 当前看门狗上限
+static uint32_t alarm_spurious_count = 0;       // 共用上限误触发次数
+
+// 报警延迟统计(事件稀少，不随WATER_ReportPerf清零)
+static PERF_Stat_TypeDef alarm_isr_perf;        // 中断进入到报警事件置位
+static PERF_Stat_TypeDef alarm_event_perf;      // 中断进入到主循环响应
 
 // 外部变量引用
 extern volatile uint32_t system_ms; // 系统毫秒计数，假设由定时器中断维护
 extern uint8_t g4_connected;  // 全局4G连接状态标志
 extern Weather_TypeDef g4_weather;  // 全局4G天气数据结构体
 
+static uint16_t WATER_Deinterleave(const uint16_t *block);
+static uint8_t WATER_Filter(uint16_t len);
+static void WATER_Adapt(uint8_t changed);
+static void WATER_Trend(void);
+#if WATER_ADAPTIVE
+static void WATER_SetRateLevel(uint8_t level);
+#endif
+static void WATER_UpdateLevel(uint8_t channel, uint8_t level);
+static void WATER_LevelStable(void);
+static void WATER_InitFilter(WaterChannel_TypeDef *wc, uint8_t channel);
+static void WATER_ArmWatchdog(void);
+static void WATER_RaiseAlarm(uint8_t channel);
+static uint32_t WATER_ConfirmTimeout(void);
+static void WATER_PresentPage(void);
+static void WATER_InitScenes(void);
+
 /**
   * @brief  初始化水位检测模块
   * @retval None
@@ -31,22 +139,96 @@ void WATER_Init(void)
     // 清空ADC缓冲区
     memset(adc_buffer, 0, sizeof(adc_buffer));
     
-    // 启动ADC和DMA传输，使用循环模式
-    HAL_ADC_Start_DMA(&hadc1, (uint32_t*)adc_buffer, ADC_BUFFER_SIZE);
+    adc_ready_half = -1;
+    adc_overrun_count = 0;
+    adapt_level = 0;
+    adapt_stable_blocks = 0;
+    adapt_switch_count = 0;
+    memset(adapt_dwell_ms, 0, sizeof(adapt_dwell_ms));
+    adapt_level_tick = TIMER_GetTick();
+    trend_tick = TIMER_GetTick();
+    PERF_Reset(&adc_irq_perf);
+    PERF_Reset(&adc_proc_perf);
+    PERF_Reset(&alarm_isr_perf);
+    PERF_Reset(&alarm_event_perf);
+    for (uint8_t ch = 0; ch < WATER_CHANNELS; ch++)
+    {
+        WATER_InitFilter(&water_ch[ch], ch);
+        HISTORY_Init(&water_ch[ch].history, WATER_HISTORY_BUCKET_MS, trend_tick);
+    }
+    
+#if WATER_ADC_MODE == WATER_ADC_TIMER
+    // 定时器触发模式：每次TIM3更新事件按顺序扫描转换全部通道
+    ADC1_ConfigTrigger(ADC_EXTERNALTRIGCONV_T3_TRGO, water_adc_channels, WATER_CHANNELS, WATER_SAMPLE_TIME);
+    WATER_SetSampleRate(WATER_SAMPLE_RATE_HZ);
+#else
+    ADC1_ConfigTrigger(ADC_SOFTWARE_START, water_adc_channels, WATER_CHANNELS, WATER_SAMPLE_TIME);
+#endif
+    HAL_ADCEx_Calibration_Start(&hadc1);
+    for (uint8_t ch = 0; ch < WATER_CHANNELS; ch++)
+    {
+        WATER_RearmAlarm(ch);
+    }
+    
+    // 启动ADC和DMA传输，使用循环模式，半传输和传输完成中断分别通知前后半区就绪
+    HAL_ADC_Start_DMA(&hadc1, (uint32_t*)adc_buffer, ADC_DMA_BUFFER_SIZE);
+#if WATER_ADC_MODE == WATER_ADC_TIMER
+    HAL_TIM_Base_Start(&htim3);
+#endif
     
     // 清屏
     OLED_Clear();
+    WATER_InitScenes();
     
     // 初始化变量
     current_page = PAGE_WATER;
     page_timer = TIMER_GetTick();
     page_lock = 0;
     water_stable_counter = 0;
+    display_channel = 0;
     
     // 显示水位页面
     WATER_DisplayWaterPage();
 }
 
+/**
+  * @brief  配置一个通道的水位滤波流水线
+  * @param  wc: 通道状态
+  * @param  channel: 水位通道，决定使用的标定表
+  * @retval None
+  */
+static void WATER_InitFilter(WaterChannel_TypeDef *wc, uint8_t channel)
+{
+    FILTER_Init(&wc->filter);
+    
+#if WATER_FILTER_MODE == WATER_FILTER_STREAM
+    WINDOW_Init(&wc->window, WATER_FILTER_PERCENT);
+    FILTER_AddWindow(&wc->filter, &wc->window);
+#else
+    FILTER_AddMedian(&wc->filter);
+#endif
+
+#if WATER_SMOOTH_MODE == WATER_SMOOTH_KALMAN
+    FILTER_AddKalman(&wc->filter, WATER_KALMAN_Q, WATER_KALMAN_R);
+#else
+    FILTER_AddIIR(&wc->filter, WATER_IIR_ALPHA);
+#endif
+    water_smooth_stage = wc->filter.count - 1;
+    
+    FILTER_AddCalib(&wc->filter, channel);
+    water_calib_stage = wc->filter.count - 1;
+    FILTER_AddHysteresis(&wc->filter, WATER_HYST_STEP, WATER_HYST_BAND);
+    
+    wc->filtered_value = 0;
+    wc->level = 0;
+    wc->alarm_false_count = 0;
+    
+    TREND_Init(&wc->trend);
+    wc->rise_rate = 0;
+    wc->time_to_threshold = TREND_NEVER;
+    wc->rise_warning = 0;
+}
+
 /**
   * @brief  水位检测处理函数，在主循环中调用
   * @retval None
@@ -54,110 +236,302 @@ void WATER_Init(void)
 void WATER_Process(void)
 {
     // 判断是否有新数据可以处理
-    if (data_ready_flag)
+    if (adc_ready_half >= 0)
     {
-        data_ready_flag = 0;
+        uint16_t *block;
+        uint16_t len;
+        uint32_t seq;
+
+        // 取出待处理半区，与DMA中断互斥
+        __disable_irq();
+        block = &adc_buffer[adc_ready_half * ADC_HALF_SIZE];
+        adc_ready_half = -1;
+        seq = adc_half_seq;
+        __enable_irq();
+
+        // 此时DMA正在填充另一半，一次遍历本半区，解交错并抽取到各通道的滤波缓冲区
+        len = WATER_Deinterleave(block);
+
+        // 遍历期间另一半也已填满，说明DMA已回到本半区，数据可能被撕裂，丢弃
+        if (adc_half_seq != seq)
+        {
+            adc_overrun_count++;
+        }
+        else
+        {
+            WATER_Adapt(WATER_Filter(len));
+            WATER_Trend();
+        }
         
-        // 保存上一次水位值用于比较
-        previous_water_level = water_level;
+        // 共用看门狗上限被误触发，每处理一个半区最多重新打开一次，避免中断风暴
+        if (alarm_spurious)
+        {
+            alarm_spurious = 0;
+            alarm_spurious_count++;
+            WATER_ArmWatchdog();
+        }
+    }
+    
+    // 处理看门狗报警事件和滤波确认
+    WATER_CheckAlarm();
+    
+    // 处理页面切换
+    WATER_PageManager();
+}
+
+/**
+  * @brief  解交错并过采样抽取，结果以Q16写入各通道的滤波缓冲区
+  * @param  block: 半区数据，按帧交错存放(每帧依次为通道0~WATER_CHANNELS-1)
+  * @retval 每个通道抽取后的样本数量
+  * @note   每WATER_OVERSAMPLE帧求一次各通道平均，整个半区只遍历一次
+  */
+static uint16_t WATER_Deinterleave(const uint16_t *block)
+{
+    uint16_t out = 0;
+    
+    for (uint16_t i = 0; i < ADC_HALF_SIZE; i += WATER_OVERSAMPLE * WATER_CHANNELS)
+    {
+        const uint16_t *frame = &block[i];
+        uint32_t sum[WATER_CHANNELS] = {0};
         
-        // 计算中位数 (中位数滤波)
-        uint16_t temp_buffer[ADC_BUFFER_SIZE];
-        // 复制数据到临时缓冲区
-        for (int i = 0; i < ADC_BUFFER_SIZE; i++)
+        for (uint16_t j = 0; j < WATER_OVERSAMPLE; j++, frame += WATER_CHANNELS)
+        {
+            for (uint8_t ch = 0; ch < WATER_CHANNELS; ch++)
+            {
+                sum[ch] += frame[ch];
+            }
+        }
+        for (uint8_t ch = 0; ch < WATER_CHANNELS; ch++)
         {
-            temp_buffer[i] = adc_buffer[i];
+            water_ch[ch].buffer[out] = FILTER_Q16((sum[ch] + WATER_OVERSAMPLE / 2) / WATER_OVERSAMPLE);
         }
+        out++;
+    }
+    
+    return out;
+}
 
-        // 冒泡排序
-        for (int i = 0; i < ADC_BUFFER_SIZE - 1; i++)
+/**
+  * @brief  各通道样本依次通过滤波流水线并更新水位
+  * @param  len: 每个通道的样本数量
+  * @retval 1: 有通道水位变化，0: 无变化
+  */
+static uint8_t WATER_Filter(uint16_t len)
+{
+    uint32_t start = PERF_CYCLES();
+    uint8_t changed = 0;
+    
+    for (uint8_t ch = 0; ch < WATER_CHANNELS; ch++)
+    {
+        WaterChannel_TypeDef *wc = &water_ch[ch];
+        uint16_t count = FILTER_Run(&wc->filter, wc->buffer, len);
+        
+        wc->filtered_value = FILTER_Q16_INT(FILTER_GetOutput(&wc->filter, water_smooth_stage));
+        
+        // 逐样本模式下流水线每个输入都有输出，水位一旦变化立即响应，而不是只看块末尾
+        for (uint16_t i = 0; i < count; i++)
         {
-            for (int j = 0; j < ADC_BUFFER_SIZE - i - 1; j++)
+            uint8_t level = FILTER_Q16_INT(wc->buffer[i]);
+            if (level != wc->level)
             {
-                if (temp_buffer[j] > temp_buffer[j + 1])
-                {
-                    uint16_t temp = temp_buffer[j];
-                    temp_buffer[j] = temp_buffer[j + 1];
-                    temp_buffer[j + 1] = temp;
-                }
+                WATER_UpdateLevel(ch, level);
+                changed = 1;
             }
         }
+    }
+    PERF_Record(&adc_proc_perf, PERF_CYCLES() - start);
+    
+    // 本块内各通道水位均未变化，按块累计稳定计数
+    if (!changed)
+    {
+        WATER_LevelStable();
+    }
+    
+    return changed;
+}
 
-        // 取中位数
-        adc_filtered_value = temp_buffer[ADC_BUFFER_SIZE / 2];
+/**
+  * @brief  自适应采样控制，每处理一个半区调用一次
+  * @param  changed: 本半区是否有通道水位变化
+  * @note   水位变化或滤波后的ADC值偏离参考值超过死区时立即回到全速，
+  *         连续WATER_ADAPT_STABLE_BLOCKS个半区稳定则降一档并更新参考值
+  * @retval None
+  */
+static void WATER_Adapt(uint8_t changed)
+{
+#if WATER_ADAPTIVE
+    for (uint8_t ch = 0; ch < WATER_CHANNELS && !changed; ch++)
+    {
+        int16_t diff = (int16_t)(water_ch[ch].filtered_value - adapt_ref[ch]);
         
-        // 根据ADC值计算水位
-        water_level = WATER_GetLevel(adc_filtered_value);
+        if (diff > WATER_ADAPT_DEADBAND || diff < -WATER_ADAPT_DEADBAND)
+        {
+            changed = 1;
+        }
+    }
+    
+    if (changed)
+    {
+        adapt_stable_blocks = 0;
+        for (uint8_t ch = 0; ch < WATER_CHANNELS; ch++)
+        {
+            adapt_ref[ch] = water_ch[ch].filtered_value;
+        }
+        if (adapt_level != 0)
+        {
+            WATER_SetRateLevel(0);
+        }
+    }
+    else if (++adapt_stable_blocks >= WATER_ADAPT_STABLE_BLOCKS && adapt_level + 1 < WATER_ADAPT_LEVELS)
+    {
+        adapt_stable_blocks = 0;
+        WATER_SetRateLevel(adapt_level + 1);
+    }
+#else
+    (void)changed;
+#endif
+}
 
-        if (print_adc_value_flag)
+#if WATER_ADAPTIVE
+/**
+  * @brief  切换采样率档位并累计上一档的停留时间
+  * @param  level: 目标档位(0~WATER_ADAPT_LEVELS-1)
+  * @retval None
+  */
+static void WATER_SetRateLevel(uint8_t level)
+{
+    uint32_t now = TIMER_GetTick();
+    
+    adapt_dwell_ms[adapt_level] += now - adapt_level_tick;
+    adapt_level_tick = now;
+    adapt_level = level;
+    adapt_switch_count++;
+    
+    WATER_SetSampleRate(WATER_SAMPLE_RATE_HZ >> level);
+}
+#endif
+
+/**
+  * @brief  按固定间隔采集趋势样本，更新上涨速率、预计到达阈值时间和预警
+  * @note   趋势估计器按累加和增量更新，每个样本O(1)
+  * @retval None
+  */
+static void WATER_Trend(void)
+{
+    uint32_t now = TIMER_GetTick();
+    
+    if ((now - trend_tick) < WATER_TREND_INTERVAL_MS)
+    {
+        return;
+    }
+    trend_tick = now;
+    
+    for (uint8_t ch = 0; ch < WATER_CHANNELS; ch++)
+    {
+        WaterChannel_TypeDef *wc = &water_ch[ch];
+        int32_t threshold = FILTER_Q16(FLASH_GetWaterThreshold(ch));
+        uint8_t warning;
+        
+        int32_t level = FILTER_GetOutput(&wc->filter, water_calib_stage);
+        
+        TREND_Push(&wc->trend, now, level);
+        level = FILTER_Q16_INT(level);
+        if (HISTORY_Add(&wc->history, now, (level < 0) ? 0 : (level > 100) ? 100 : level) > 0 &&
+            current_page == PAGE_HISTORY && display_channel == ch)
         {
-            // SEGGER_RTT_printf(0, "%d\n", adc_filtered_value);
-            print_adc_value_flag = 0;
+            WATER_DisplayHistoryPage(); // 新增一个桶，曲线左移一列
         }
+        wc->rise_rate = TREND_Rate(&wc->trend);
+        wc->time_to_threshold = TREND_TimeTo(&wc->trend, threshold);
         
-        // 检查水位是否变化
-        if (water_level != previous_water_level)
+        // 已到达阈值由报警状态机处理；解除预警留一倍提前量的回差，避免来回跳变
+        if (wc->rise_rate < WATER_TREND_MIN_RATE || wc->time_to_threshold == 0)
         {
-            // 水位变化，锁定在水位页面
-            page_lock = 1;
-            water_stable_counter = 0;
-            
-            // 如果当前不是水位页面，则切换到水位页面
-            if (current_page != PAGE_WATER)
+            warning = 0;
+        }
+        else if (wc->rise_warning)
+        {
+            warning = wc->time_to_threshold < WATER_TREND_LEAD_S * 2;
+        }
+        else
+        {
+            warning = wc->time_to_threshold < WATER_TREND_LEAD_S;
+        }
+        
+        if (warning != wc->rise_warning)
+        {
+            wc->rise_warning = warning;
+            if (warning)
             {
-                WATER_SwitchPage(PAGE_WATER);
-                WATER_DisplayWaterPage(); // 切换后显示完整水位页面
+                // 提前预警：与报警相同，锁定水位页面并请求上传
+                WATER_RaiseAlarm(ch);
             }
-            else if (current_page == PAGE_WATER)
+            else if (current_page == PAGE_WATER && display_channel == ch)
             {
-                // 更新整个水位页面而不只是数值
                 WATER_DisplayWaterPage();
             }
         }
-        else
+    }
+}
+
+/**
+  * @brief  水位变化，锁定并刷新水位页面
+  * @param  channel: 水位通道
+  * @param  level: 滤波流水线输出的水位百分比
+  * @retval None
+  */
+static void WATER_UpdateLevel(uint8_t channel, uint8_t level)
+{
+    water_ch[channel].level = level;
+    
+    // 水位变化，锁定在水位页面并显示该通道
+    page_lock = 1;
+    water_stable_counter = 0;
+    display_channel = channel;
+    
+    // 如果当前不是水位页面，则切换到水位页面
+    if (current_page != PAGE_WATER)
+    {
+        WATER_SwitchPage(PAGE_WATER);
+    }
+    // 更新整个水位页面而不只是数值
+    WATER_DisplayWaterPage();
+}
+
+/**
+  * @brief  水位未变化，累计稳定计数，达到阈值后解除页面锁定
+  * @retval None
+  */
+static void WATER_LevelStable(void)
+{
+    if (page_lock && water_stable_counter < WATER_STABLE_COUNT)
+    {
+        water_stable_counter++;
+        
+        // 达到稳定阈值，解除锁定
+        if (water_stable_counter >= WATER_STABLE_COUNT)
         {
-            // 水位未变化，增加稳定计数
-            if (page_lock && water_stable_counter < WATER_STABLE_COUNT)
-            {
-                water_stable_counter++;
-                
-                // 达到稳定阈值，解除锁定
-                if (water_stable_counter >= WATER_STABLE_COUNT)
-                {
-                    page_lock = 0;
-                    page_timer = TIMER_GetTick(); // 重置页面计时器
-                }
-            }
+            page_lock = 0;
+            page_timer = TIMER_GetTick(); // 重置页面计时器
         }
     }
-    
-    // 处理页面切换
-    WATER_PageManager();
 }
 
 /**
   * @brief  根据ADC值计算水位百分比
+  * @param  channel: 水位通道
   * @param  adc_value: ADC采样值
   * @retval 水位百分比 (0-100)
   */
-uint8_t WATER_GetLevel(uint16_t adc_value)
+uint8_t WATER_GetLevel(uint8_t channel, uint16_t adc_value)
 {
-    uint8_t ans;
-    
-    if (adc_value >= 2450) ans = 100;
-    else if (adc_value >= 1800) ans = 90;
-    else if (adc_value >= 1150) ans = 80;
-    else if (adc_value >= 830) ans = 70;
-    else if (adc_value >= 600) ans = 60;
-    else if (adc_value >= 500) ans = 50;
-    else if (adc_value >= 430) ans = 40;
-    else if (adc_value >= 380) ans = 30;
-    else if (adc_value >= 320) ans = 20;
-    else if (adc_value >= 270) ans = 10;
-    else ans = 0;
+    if (channel >= WATER_CHANNELS)
+    {
+        return 0;
+    }
     
-    return ans;
-
+    // 查该通道的标定表并线性插值，标定表可通过MQTT下发并保存在Flash中
+    return CALIB_Lookup(channel, adc_value);
 }
 
 /**
@@ -167,64 +541,78 @@ uint8_t WATER_GetLevel(uint16_t adc_value)
   */
 void WATER_DisplayTimePage(RTC_TimeTypeDef *time)
 {
-    char buffer[32];
-    uint8_t x_pos;
+    // 最长的一行是"天气 气温C"
+    char buffer[sizeof(g4_weather.text) + sizeof(g4_weather.temperature) + 2];
+    
+    SCENE_Begin(&time_scene);
     
     // 第一行：日期（居中）
     sprintf(buffer, "20%02d-%02d-%02d", time->year, time->month, time->day);
-    x_pos = (128 - strlen(buffer) * 8) / 2;
-    OLED_ShowString(x_pos, 0, buffer, 16);
+    SCENE_SetText(&time_widgets[TIME_W_DATE], buffer);
     
-    // 第二行：时间 星期缩写（居中）
+    // 第二行：时间 星期缩写（居中），每秒只有秒数字符重绘
     const char* week_days[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
     sprintf(buffer, "%02d:%02d:%02d %s", time->hour, time->minute, time->second, week_days[time->week % 7]);
-    x_pos = (128 - strlen(buffer) * 8) / 2;
-    OLED_ShowString(x_pos, 2, buffer, 16);
+    SCENE_SetText(&time_widgets[TIME_W_TIME], buffer);
     
-    // 第三行：城市（居中）
+    // 第三行：城市，第四行：天气状况 气温（居中）
     if (g4_weather.updated) {
-        // 已获取天气数据
-        sprintf(buffer, "%s", g4_weather.city);
-        x_pos = (128 - strlen(buffer) * 8) / 2;
-        OLED_ShowString(x_pos, 4, buffer, 16);
-        
-        // 第四行：天气状况 气温（居中）
+        SCENE_SetText(&time_widgets[TIME_W_CITY], g4_weather.city);
         sprintf(buffer, "%s %sC", g4_weather.text, g4_weather.temperature);
-        x_pos = (128 - strlen(buffer) * 8) / 2;
-        OLED_ShowString(x_pos, 6, buffer, 16);
+        SCENE_SetText(&time_widgets[TIME_W_WEATHER], buffer);
     } else {
         // 未获取天气数据
-        strcpy(buffer, "Weather Loading...");
-        x_pos = (128 - strlen(buffer) * 8) / 2;
-        OLED_ShowString(x_pos, 4, buffer, 16);
-        
-        OLED_ShowString(0, 6, "                ", 16); // 清空第四行
+        SCENE_SetText(&time_widgets[TIME_W_CITY], "Weather Loading...");
+        SCENE_SetText(&time_widgets[TIME_W_WEATHER], "");
     }
+    
+    WATER_PresentPage();
 }
 
 /**
-  * @brief  显示水位页面
+  * @brief  显示水位历史页面：最近1小时曲线，每列一个桶
+  * @retval None
+  */
+void WATER_DisplayHistoryPage(void)
+{
+    char buffer[32];
+    
+    SCENE_Begin(&history_scene);
+    
+#if WATER_CHANNELS > 1
+    sprintf(buffer, "1h Ch%u %3u%%", display_channel + 1, water_ch[display_channel].level);
+#else
+    sprintf(buffer, "Last 1h %3u%%", water_ch[display_channel].level);
+#endif
+    SCENE_SetText(&history_widgets[HISTORY_W_TITLE], buffer);
+    SCENE_SetHistory(&history_widgets[HISTORY_W_GRAPH], &water_ch[display_channel].history);
+    
+    WATER_PresentPage();
+}
+
+/**
+  * @brief  显示水位页面(最近变化或报警的通道)
   * @retval None
   */
 void WATER_DisplayWaterPage(void)
 {
     char buffer[32];
-    uint16_t threshold = FLASH_GetWaterThreshold();
-    uint8_t x_pos;
+    WaterChannel_TypeDef *wc = &water_ch[display_channel];
+    uint8_t water_level = wc->level;
+    uint16_t threshold = FLASH_GetWaterThreshold(display_channel);
+    uint8_t alarm = (water_level >= threshold || wc->alarm_state != WATER_ALARM_ARMED);
     
-    // 显示水位页面标题（包含4G状态，居中显示）
-    if (g4_connected)
-    {
-        strcpy(buffer, "Water Level 4G+");
-    }
-    else
-    {
-        strcpy(buffer, "Water Level 4G-");
-    }
-    // 计算居中位置 (128 - 字符数*8) / 2
-    // 16像素字体下ASCII字符宽度为8像素
-    x_pos = (128 - strlen(buffer) * 8) / 2;
-    OLED_ShowString(x_pos, 0, buffer, 16);
+    SCENE_Begin(&water_scene);
+    
+    // 标题行：报警图标、标题(多通道时显示通道号)、4G状态图标
+#if WATER_CHANNELS > 1
+    sprintf(buffer, "Water %u/%u", display_channel + 1, WATER_CHANNELS);
+    SCENE_SetText(&water_widgets[WATER_W_TITLE], buffer);
+#else
+    SCENE_SetText(&water_widgets[WATER_W_TITLE], "Water Level");
+#endif
+    SCENE_SetValue(&water_widgets[WATER_W_ALARM], alarm ? SCENE_ICON_ALARM : SCENE_ICON_BLANK);
+    SCENE_SetValue(&water_widgets[WATER_W_4G], g4_connected ? SCENE_ICON_SIGNAL : SCENE_ICON_NO_SIGNAL);
     
     // 显示当前水位百分比和与阈值的比较关系（居中）
     if (water_level >= threshold)
@@ -235,46 +623,72 @@ void WATER_DisplayWaterPage(void)
     {
         sprintf(buffer, "%3d%% < %3d%% ", water_level, threshold);
     }
-    x_pos = (128 - strlen(buffer) * 8) / 2;
-    OLED_ShowString(x_pos, 2, buffer, 16);
+    SCENE_SetText(&water_widgets[WATER_W_VALUE], buffer);
     
-    // 显示水位条形图边框（居中）
-    strcpy(buffer, "[          ]");
-    x_pos = (128 - strlen(buffer) * 8) / 2;
-    OLED_ShowString(x_pos, 4, buffer, 16);
+    // 水位条形图，只重绘填充变化的列
+    SCENE_SetValue(&water_widgets[WATER_W_BAR], water_level);
     
-    // 水位条形图填充
-    uint8_t bar_length = water_level / 10;
-    memset(buffer, 0, sizeof(buffer));
-    buffer[0] = '[';
-    for (int i = 0; i < 10; i++)
+    // 如果水位超过阈值或看门狗已报警，显示报警信息（居中）
+    if (alarm)
     {
-        if (i < bar_length)
-            buffer[i+1] = '=';
-        else
-            buffer[i+1] = ' ';
+        SCENE_SetText(&water_widgets[WATER_W_STATUS], "!!! ALARM !!!");
     }
-    buffer[11] = ']';
-    buffer[12] = '\0';
-    
-    OLED_ShowString(x_pos, 4, buffer, 16);
-    
-    // 如果水位超过阈值，显示报警信息（居中）
-    if (water_level >= threshold)
+    else if (wc->rise_warning)
     {
-        strcpy(buffer, "!!! ALARM !!!");
-        x_pos = (128 - strlen(buffer) * 8) / 2;
-        OLED_ShowString(x_pos, 6, buffer, 16);
+        // 提前预警，显示预计到达阈值的时间
+        sprintf(buffer, "FULL IN %4lus", (unsigned long)wc->time_to_threshold);
+        SCENE_SetText(&water_widgets[WATER_W_STATUS], buffer);
     }
     else
     {
         // 清除报警信息行
-        OLED_ShowString(0, 6, "               ", 16);
+        SCENE_SetText(&water_widgets[WATER_W_STATUS], "");
+    }
+    
+    // 只把与屏幕内容不同的区域写出，DMA在后台完成
+    WATER_PresentPage();
+}
+
+/**
+  * @brief  初始化水位页面和时间页面的控件布局
+  * @retval None
+  */
+static void WATER_InitScenes(void)
+{
+    SCENE_InitIcon(&water_widgets[WATER_W_ALARM], 0, 0);
+    SCENE_InitLabel(&water_widgets[WATER_W_TITLE], 8, 0, 112, 16);
+    SCENE_InitIcon(&water_widgets[WATER_W_4G], 120, 0);
+    SCENE_InitLabel(&water_widgets[WATER_W_VALUE], 0, 2, OLED_WIDTH, 16);
+    SCENE_InitBar(&water_widgets[WATER_W_BAR], 13, 4, 102);
+    SCENE_InitLabel(&water_widgets[WATER_W_STATUS], 0, 6, OLED_WIDTH, 16);
+    SCENE_Init(&water_scene, water_widgets, WATER_W_COUNT);
+    
+    for (uint8_t i = 0; i < TIME_W_COUNT; i++)
+    {
+        SCENE_InitLabel(&time_widgets[i], 0, i * 2, OLED_WIDTH, 16);
     }
+    SCENE_Init(&time_scene, time_widgets, TIME_W_COUNT);
+    
+    SCENE_InitLabel(&history_widgets[HISTORY_W_TITLE], 0, 0, OLED_WIDTH, 16);
+    SCENE_InitGraph(&history_widgets[HISTORY_W_GRAPH], (OLED_WIDTH - HISTORY_SIZE) / 2, 2, HISTORY_SIZE, 6);
+    SCENE_Init(&history_scene, history_widgets, HISTORY_W_COUNT);
 }
 
 /**
-  * @brief  页面管理器，处理页面切换逻辑
+  * @brief  把绘制好的页面写出：刚切换页面时从后台缓存换入，否则直接刷新差异
+  * @retval None
+  */
+static void WATER_PresentPage(void)
+{
+    if (OLED_IsComposing())
+    {
+        OLED_EndFrame(page_transition);
+    }
+    OLED_StartFlush();
+}
+
+/**
+  * @brief  页面管理器，处理页面切换逻辑(水位 -> 时间 -> 历史曲线 -> 水位)
   * @retval None
   */
 void WATER_PageManager(void)
@@ -293,6 +707,7 @@ void WATER_PageManager(void)
         {
             // 切换到时间页面
             WATER_SwitchPage(PAGE_TIME);
+            page_transition = WATER_PAGE_TRANSITION;
             
             // 显示时间内容
             RTC_TimeTypeDef time;
@@ -301,11 +716,23 @@ void WATER_PageManager(void)
                 // 修改DisplayTimePage函数删除内部的OLED_Clear调用
                 WATER_DisplayTimePage(&time);
             }
+            else
+            {
+                WATER_PresentPage(); // 读取时间失败，至少把空白页面换上
+            }
+        }
+        else if (current_page == PAGE_TIME)
+        {
+            // 切换到历史曲线页面
+            WATER_SwitchPage(PAGE_HISTORY);
+            page_transition = WATER_PAGE_TRANSITION;
+            WATER_DisplayHistoryPage();
         }
         else
         {
             // 切换到水位页面
             WATER_SwitchPage(PAGE_WATER);
+            page_transition = WATER_PAGE_TRANSITION;
             
             // 修改DisplayWaterPage函数删除内部的OLED_Clear调用
             WATER_DisplayWaterPage();
@@ -317,11 +744,14 @@ void WATER_PageManager(void)
   * @brief  切换页面
   * @param  page: 目标页面
   * @retval None
+  * @note   新页面在后台缓存中合成，屏幕保持旧页面，由随后的页面绘制函数整体换入；
+  *         默认直接切换，定时轮换时由调用者改为WATER_PAGE_TRANSITION
   */
 void WATER_SwitchPage(DisplayPage_TypeDef page)
 {
-    // 清屏，防止页面内容重叠
-    OLED_Clear();
+    // 在空白后台缓存中合成新页面，防止页面内容重叠
+    OLED_BeginFrame();
+    page_transition = OLED_TRANS_NONE;
     
     // 更新页面状态
     current_page = page;
@@ -329,7 +759,240 @@ void WATER_SwitchPage(DisplayPage_TypeDef page)
 }
 
 /**
-  * @brief  ADC DMA转换完成回调函数
+  * @brief  按Flash中的水位阈值重新布防一个通道的报警
+  * @param  channel: 水位通道
+  * @note   看门狗模式下阈值经该通道标定表反查为ADC值，修改阈值或标定表后需调用；
+  *         从PENDING/ACTIVE回到ARMED时刷新水位页面，清除报警标志
+  * @retval None
+  */
+void WATER_RearmAlarm(uint8_t channel)
+{
+    WaterChannel_TypeDef *wc;
+    WaterAlarm_TypeDef previous;
+    
+    if (channel >= WATER_CHANNELS)
+    {
+        return;
+    }
+    wc = &water_ch[channel];
+    previous = wc->alarm_state;
+    
+    wc->alarm_adc_threshold = CALIB_LevelToAdc(channel, FLASH_GetWaterThreshold(channel));
+    wc->alarm_state = WATER_ALARM_ARMED;
+    WATER_ArmWatchdog();
+    
+    // 本轮WATER_UpdateLevel已按报警状态画过页面，报警解除后需重画
+    if (previous != WATER_ALARM_ARMED && current_page == PAGE_WATER && display_channel == channel)
+    {
+        WATER_DisplayWaterPage();
+    }
+}
+
+/**
+  * @brief  按已布防通道重新配置ADC模拟看门狗
+  * @note   F1只有一个看门狗，扫描模式下监视全部通道，上限取已布防通道中
+  *         最低的报警ADC值，中断里再按各通道自身阈值判断
+  * @retval None
+  */
+static void WATER_ArmWatchdog(void)
+{
+#if WATER_ALARM_MODE == WATER_ALARM_WATCHDOG
+    ADC_AnalogWDGConfTypeDef awd = {0};
+    uint16_t adc = 4096;
+    
+    for (uint8_t ch = 0; ch < WATER_CHANNELS; ch++)
+    {
+        if (water_ch[ch].alarm_state == WATER_ALARM_ARMED && water_ch[ch].alarm_adc_threshold < adc)
+        {
+            adc = water_ch[ch].alarm_adc_threshold;
+        }
+    }
+    
+    // 没有已布防的通道，关闭看门狗中断
+    if (adc > 4095)
+    {
+        __HAL_ADC_DISABLE_IT(&hadc1, ADC_IT_AWD);
+        return;
+    }
+    
+    // 看门狗在转换值大于上限时触发，上限取达到阈值的最小ADC值减1
+    alarm_watchdog_high = adc ? adc - 1 : 0;
+    
+    awd.WatchdogMode = ADC_ANALOGWATCHDOG_ALL_REG;
+    awd.ITMode = ENABLE;
+    awd.HighThreshold = alarm_watchdog_high;
+    awd.LowThreshold = 0;
+    
+    __HAL_ADC_CLEAR_FLAG(&hadc1, ADC_FLAG_AWD);
+    HAL_ADC_AnalogWDGConfig(&hadc1, &awd);
+#endif
+}
+
+/**
+  * @brief  报警状态机，在主循环中调用
+  * @note   看门狗报警后立即切到该通道的水位页面、恢复全速采样并请求上传，滤波后的水位
+  *         在WATER_ConfirmTimeout内达到阈值则确认，否则视为干扰重新布防
+  * @retval None
+  */
+void WATER_CheckAlarm(void)
+{
+    uint8_t events;
+    
+    __disable_irq();
+    events = alarm_event;
+    alarm_event = 0;
+    __enable_irq();
+    
+    if (events)
+    {
+        PERF_Record(&alarm_event_perf, PERF_CYCLES() - alarm_irq_stamp);
+        // 中断里已关闭看门狗，其余已布防的通道需继续监视
+        WATER_ArmWatchdog();
+#if WATER_ADAPTIVE
+        // 确认前恢复全速，降档时一个半区就比确认时间长
+        adapt_stable_blocks = 0;
+        if (adapt_level != 0)
+        {
+            WATER_SetRateLevel(0);
+        }
+#endif
+    }
+    
+    for (uint8_t ch = 0; ch < WATER_CHANNELS; ch++)
+    {
+        WaterChannel_TypeDef *wc = &water_ch[ch];
+        uint16_t threshold = FLASH_GetWaterThreshold(ch);
+        
+        if (events & (1 << ch))
+        {
+            wc->alarm_pending_tick = TIMER_GetTick();
+            wc->alarm_confirm_ms = WATER_ConfirmTimeout();
+            WATER_RaiseAlarm(ch);
+        }
+        
+        switch (wc->alarm_state)
+        {
+        case WATER_ALARM_ARMED:
+            // 轮询模式，或水位在布防前已超过阈值
+            if (wc->level >= threshold)
+            {
+                wc->alarm_state = WATER_ALARM_ACTIVE;
+                WATER_ArmWatchdog();
+                WATER_RaiseAlarm(ch);
+            }
+            break;
+        
+        case WATER_ALARM_PENDING:
+            if (wc->level >= threshold)
+            {
+                wc->alarm_state = WATER_ALARM_ACTIVE;
+            }
+            else if ((TIMER_GetTick() - wc->alarm_pending_tick) >= wc->alarm_confirm_ms)
+            {
+                // 原始样本的尖峰触发了看门狗，滤波后未达到阈值
+                wc->alarm_false_count++;
+                WATER_RearmAlarm(ch);
+            }
+            break;
+        
+        case WATER_ALARM_ACTIVE:
+            // 水位回落到阈值以下，重新布防
+            if (wc->level < threshold)
+            {
+                WATER_RearmAlarm(ch);
+            }
+            break;
+        }
+    }
+}
+
+/**
+  * @brief  看门狗报警后等待滤波确认的最长时间
+  * @retval 时间(ms)
+  * @note   按当前采样率计算：填满正在采集的半区，滑动窗口中位数再需要半个窗口的新样本
+  *         才能越过阶跃，WATER_ALARM_CONFIRM_MS为平滑级留出的余量
+  */
+static uint32_t WATER_ConfirmTimeout(void)
+{
+    uint32_t samples = ADC_BUFFER_SIZE;
+    
+#if WATER_FILTER_MODE == WATER_FILTER_STREAM
+    samples += (WINDOW_SIZE / 2) * WATER_OVERSAMPLE;
+#endif
+    // 连续转换模式下采样延迟可以忽略
+    if (adc_sample_rate == 0)
+    {
+        return WATER_ALARM_CONFIRM_MS;
+    }
+    return WATER_ALARM_CONFIRM_MS + samples * 1000 / adc_sample_rate;
+}
+
+/**
+  * @brief  报警响应：锁定并刷新该通道的水位页面，请求立即上传
+  * @param  channel: 报警的水位通道
+  * @retval None
+  */
+static void WATER_RaiseAlarm(uint8_t channel)
+{
+    page_lock = 1;
+    water_stable_counter = 0;
+    display_channel = channel;
+    
+    if (current_page != PAGE_WATER)
+    {
+        WATER_SwitchPage(PAGE_WATER);
+    }
+    WATER_DisplayWaterPage();
+    
+    g4_upload_flag = 1;
+}
+
+/**
+  * @brief  获取报警状态
+  * @param  channel: 水位通道
+  * @retval 报警状态，通道无效时返回WATER_ALARM_ARMED
+  */
+WaterAlarm_TypeDef WATER_GetAlarmState(uint8_t channel)
+{
+    if (channel >= WATER_CHANNELS)
+    {
+        return WATER_ALARM_ARMED;
+    }
+    
+    return water_ch[channel].alarm_state;
+}
+
+/**
+  * @brief  标记一个半区数据就绪
+  * @param  half: 半区编号(0:前半，1:后半)
+  * @retval None
+  */
+static void WATER_HalfReady(int8_t half)
+{
+    // 上一个半区还未被处理，主循环落后了整整一个缓冲区
+    if (adc_ready_half >= 0)
+    {
+        adc_overrun_count++;
+    }
+    adc_ready_half = half;
+    adc_half_seq++;
+}
+
+/**
+  * @brief  ADC DMA半传输完成回调函数，前半区数据就绪
+  * @param  hadc: ADC句柄
+  * @retval None
+  */
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef* hadc)
+{
+    if (hadc->Instance == ADC1)
+    {
+        WATER_HalfReady(0);
+    }
+}
+
+/**
+  * @brief  ADC DMA转换完成回调函数，后半区数据就绪
   * @param  hadc: ADC句柄
   * @retval None
   */
@@ -337,8 +1000,59 @@ void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef* hadc)
 {
     if (hadc->Instance == ADC1)
     {
-        // 设置数据就绪标志
-        data_ready_flag = 1;
+        WATER_HalfReady(1);
+    }
+}
+
+/**
+  * @brief  记录ADC中断进入时刻，在ADC1_2_IRQHandler开头调用
+  * @param  cycles: 进入中断时的DWT周期计数
+  * @retval None
+  */
+void WATER_AlarmIrqEnter(uint32_t cycles)
+{
+    alarm_irq_entry = cycles;
+}
+
+/**
+  * @brief  ADC模拟看门狗回调函数，转换值超过水位阈值对应的ADC值
+  * @param  hadc: ADC句柄
+  * @retval None
+  */
+void HAL_ADC_LevelOutOfWindowCallback(ADC_HandleTypeDef* hadc)
+{
+    if (hadc->Instance == ADC1)
+    {
+        // DMA刚写入的一帧包含触发看门狗的转换结果
+        uint16_t pos = ADC_DMA_BUFFER_SIZE - __HAL_DMA_GET_COUNTER(hadc->DMA_Handle);
+        uint8_t events = 0;
+        
+        // 超过上限期间每次转换都会触发，先关闭中断，由主循环重新打开
+        __HAL_ADC_DISABLE_IT(hadc, ADC_IT_AWD);
+        
+        // 检查每个通道最近一个样本是否超过自身阈值
+        for (uint8_t i = 0; i < WATER_CHANNELS; i++)
+        {
+            uint16_t index = (pos + ADC_DMA_BUFFER_SIZE - 1 - i) % ADC_DMA_BUFFER_SIZE;
+            WaterChannel_TypeDef *wc = &water_ch[index % WATER_CHANNELS];
+            
+            if (wc->alarm_state == WATER_ALARM_ARMED && adc_buffer[index] >= wc->alarm_adc_threshold)
+            {
+                wc->alarm_state = WATER_ALARM_PENDING;
+                events |= 1 << (index % WATER_CHANNELS);
+            }
+        }
+        
+        if (events)
+        {
+            alarm_irq_stamp = alarm_irq_entry;
+            alarm_event |= events;
+            PERF_Record(&alarm_isr_perf, PERF_CYCLES() - alarm_irq_entry);
+        }
+        else
+        {
+            alarm_spurious = 1;
+        }
     }
 }
 
@@ -352,7 +1066,335 @@ uint8_t WATER_IsPageLocked(void)
     return page_lock;
 }
 
-uint8_t WATER_GetCurrentLevel(void)
+/**
+  * @brief  获取当前水位
+  * @param  channel: 水位通道
+  * @retval 水位百分比，通道无效时返回0
+  */
+uint8_t WATER_GetCurrentLevel(uint8_t channel)
+{
+    if (channel >= WATER_CHANNELS)
+    {
+        return 0;
+    }
+    
+    return water_ch[channel].level;
+}
+
+/**
+  * @brief  获取ADC数据溢出(丢弃)次数
+  * @retval 溢出次数
+  */
+uint32_t WATER_GetOverrunCount(void)
 {
-    return water_level;
+    return adc_overrun_count;
+}
+
+/**
+  * @brief  获取最近窗口内任意分位数的ADC值
+  * @param  channel: 水位通道
+  * @param  percent: 分位数(0-100)
+  * @retval ADC值，块滤波模式下返回最近一次平滑后的中位数，通道无效时返回0
+  */
+uint16_t WATER_GetPercentile(uint8_t channel, uint8_t percent)
+{
+    if (channel >= WATER_CHANNELS)
+    {
+        return 0;
+    }
+    
+#if WATER_FILTER_MODE == WATER_FILTER_STREAM
+    return WINDOW_Percentile(&water_ch[channel].window, percent);
+#else
+    (void)percent;
+    return water_ch[channel].filtered_value;
+#endif
+}
+
+/**
+  * @brief  获取水位上涨速率
+  * @param  channel: 水位通道
+  * @retval 最近TREND_SIZE个趋势样本拟合的速率(Q16 %/秒，负数为下降)，通道无效时返回0
+  */
+int32_t WATER_GetRiseRate(uint8_t channel)
+{
+    if (channel >= WATER_CHANNELS)
+    {
+        return 0;
+    }
+    
+    return water_ch[channel].rise_rate;
+}
+
+/**
+  * @brief  获取按当前速率预计到达水位阈值的时间
+  * @param  channel: 水位通道
+  * @retval 秒数，已达到阈值返回0，不上涨或通道无效返回TREND_NEVER
+  */
+uint32_t WATER_GetTimeToThreshold(uint8_t channel)
+{
+    if (channel >= WATER_CHANNELS)
+    {
+        return TREND_NEVER;
+    }
+    
+    return water_ch[channel].time_to_threshold;
+}
+
+/**
+  * @brief  是否处于上涨提前预警
+  * @param  channel: 水位通道
+  * @retval 1: 预计WATER_TREND_LEAD_S秒内到达阈值，0: 否
+  */
+uint8_t WATER_IsRiseWarning(uint8_t channel)
+{
+    if (channel >= WATER_CHANNELS)
+    {
+        return 0;
+    }
+    
+    return water_ch[channel].rise_warning;
+}
+
+/**
+  * @brief  设置ADC采样率(仅定时器触发模式有效)
+  * @param  rate_hz: 采样率(Hz)，范围2~WATER_TIMER_CLOCK_HZ
+  * @retval None
+  */
+void WATER_SetSampleRate(uint16_t rate_hz)
+{
+#if WATER_ADC_MODE == WATER_ADC_TIMER
+    if (rate_hz < 2)
+    {
+        rate_hz = 2;
+    }
+    
+    // ARR开启了预装载，新周期在下一次更新事件生效，不会打乱当前周期
+    __HAL_TIM_SET_AUTORELOAD(&htim3, WATER_TIMER_CLOCK_HZ / rate_hz - 1);
+    adc_sample_rate = WATER_TIMER_CLOCK_HZ / (WATER_TIMER_CLOCK_HZ / rate_hz);
+#else
+    (void)rate_hz;
+#endif
+}
+
+/**
+  * @brief  获取当前ADC采样率
+  * @retval 采样率(Hz)，连续转换模式返回0
+  */
+uint16_t WATER_GetSampleRate(void)
+{
+    return adc_sample_rate;
+}
+
+/**
+  * @brief  获取当前自适应采样档位
+  * @retval 档位，0为全速，第n档采样率为WATER_SAMPLE_RATE_HZ >> n
+  */
+uint8_t WATER_GetRateLevel(void)
+{
+    return adapt_level;
+}
+
+/**
+  * @brief  获取某个采样率档位的累计停留时间
+  * @param  level: 档位(0~WATER_ADAPT_LEVELS-1)
+  * @retval 停留时间(ms)，含当前档位正在进行的时间
+  */
+uint32_t WATER_GetRateDwell(uint8_t level)
+{
+    if (level >= WATER_ADAPT_LEVELS)
+    {
+        return 0;
+    }
+    if (level == adapt_level)
+    {
+        return adapt_dwell_ms[level] + (TIMER_GetTick() - adapt_level_tick);
+    }
+    
+    return adapt_dwell_ms[level];
+}
+
+/**
+  * @brief  记录一次ADC DMA中断耗时，在DMA1_Channel1_IRQHandler中调用
+  * @param  cycles: 中断耗费的周期数
+  * @retval None
+  */
+void WATER_RecordIrqCycles(uint32_t cycles)
+{
+    PERF_Record(&adc_irq_perf, cycles);
+}
+
+/**
+  * @brief  通过RTT输出ADC采集开销并清零统计，建议每秒调用一次
+  * @note   CPU占用率 = (中断总周期 + 处理总周期) / 每秒周期数
+  * @retval None
+  */
+void WATER_ReportPerf(void)
+{
+    uint64_t busy = adc_irq_perf.total + adc_proc_perf.total;
+    
+    SEGGER_RTT_printf(0, "adc mode=%s ch=%u rate=%uHz osr=%u irq/s=%u load=%u.%02u%% overrun=%u\n",
+                      (WATER_ADC_MODE == WATER_ADC_TIMER) ? "timer" : "continuous",
+                      WATER_CHANNELS, adc_sample_rate, WATER_OVERSAMPLE, adc_irq_perf.count,
+                      (uint32_t)(busy * 100 / SystemCoreClock),
+                      (uint32_t)(busy * 10000 / SystemCoreClock % 100),
+                      adc_overrun_count);
+    SEGGER_RTT_printf(0, "adapt level=%u switches=%u dwell ms:", adapt_level, adapt_switch_count);
+    for (uint8_t i = 0; i < WATER_ADAPT_LEVELS; i++)
+    {
+        SEGGER_RTT_printf(0, " %u", WATER_GetRateDwell(i));
+    }
+    SEGGER_RTT_printf(0, "\n");
+    PERF_Print("adc irq", &adc_irq_perf);
+    PERF_Print("adc proc", &adc_proc_perf);
+    
+    SEGGER_RTT_printf(0, "alarm mode=%s awd>%u spurious=%u\n",
+                      (WATER_ALARM_MODE == WATER_ALARM_WATCHDOG) ? "watchdog" : "poll",
+                      alarm_watchdog_high, alarm_spurious_count);
+    for (uint8_t ch = 0; ch < WATER_CHANNELS; ch++)
+    {
+        WaterChannel_TypeDef *wc = &water_ch[ch];
+        
+        SEGGER_RTT_printf(0, "ch%u level=%u adc=%u alarm=%u adc>=%u false=%u rise=%d/65536%%/s eta=%us warn=%u\n",
+                          ch, wc->level, wc->filtered_value, wc->alarm_state,
+                          wc->alarm_adc_threshold, wc->alarm_false_count,
+                          wc->rise_rate, wc->time_to_threshold, wc->rise_warning);
+        FILTER_Report(&wc->filter);
+    }
+    PERF_Print("alarm isr->event", &alarm_isr_perf);
+    PERF_Print("alarm isr->loop", &alarm_event_perf);
+    
+    // 显示写屏开销：每秒累计值和最近一帧
+    OLED_Stat_TypeDef oled;
+    OLED_GetStats(&oled);
+    SEGGER_RTT_printf(0, "oled frames=%u bytes=%u xfers=%u dc=%u last frame bytes=%u xfers=%u dc=%u\n",
+                      oled.frames, oled.bytes, oled.transfers, oled.dc_toggles,
+                      oled.frame_bytes, oled.frame_transfers, oled.frame_dc_toggles);
+#ifdef OLED_MIRROR
+    SEGGER_RTT_printf(0, "oled mirror diff=%u\n", OLED_MirrorCheck());
+#endif
+    OLED_ResetStats();
+    
+    SEGGER_RTT_printf(0, "4G tx depth=%u inflight=%u rx dropped=%u\n",
+                      G4_GetTxDepth(), G4_GetTxInFlight(), G4_GetDroppedBytes());
+    
+    PERF_Reset(&adc_irq_perf);
+    PERF_Reset(&adc_proc_perf);
+}
+
+#ifdef OLED_BENCHMARK
+#define OLED_BENCH_ROUNDS 10
+#define OLED_BENCH_FPS_FRAMES 100
+
+/**
+  * @brief  输出一次写屏的字节数、SPI传输次数和DC切换次数(自上次OLED_ResetStats起累计)
+  * @param  name: 写屏方式
+  * @retval None
+  */
+static void WATER_PrintOledStat(const char *name)
+{
+    OLED_Stat_TypeDef stat;
+    
+    OLED_GetStats(&stat);
+    SEGGER_RTT_printf(0, "%s bytes=%u xfers=%u dc=%u\n", name, stat.bytes, stat.transfers, stat.dc_toggles);
+}
+
+/**
+  * @brief  水位页面整屏重绘基准测试，通过RTT输出
+  * @note   bytewise: 改造前的逐字节写屏方式写出整屏；
+  *         span: 同一帧按页一次DMA连续写出；
+  *         page cpu/page total: 清屏后完整重绘水位页面，分别计到函数返回和DMA刷新结束；
+  *         pages/full fps: 强制逐页或整帧方式连续刷新整屏，得到两种方式的帧率上限；
+  *         每种方式另输出一帧的写屏字节数和传输次数(与时钟无关，主机测试test_pages得到同样的数)
+  * @retval None
+  */
+void WATER_DisplayBenchmark(void)
+{
+    PERF_Stat_TypeDef bytewise, span, page_cpu, page_total;
+    uint32_t start;
+    
+    PERF_Reset(&bytewise);
+    PERF_Reset(&span);
+    PERF_Reset(&page_cpu);
+    PERF_Reset(&page_total);
+    
+    for (uint8_t r = 0; r < OLED_BENCH_ROUNDS; r++)
+    {
+        OLED_Clear();
+        OLED_Invalidate();
+        start = PERF_CYCLES();
+        WATER_DisplayWaterPage();
+        PERF_Record(&page_cpu, PERF_CYCLES() - start);
+        while (OLED_IsBusy());
+        PERF_Record(&page_total, PERF_CYCLES() - start);
+        
+        OLED_Invalidate();
+        start = PERF_CYCLES();
+        OLED_Refresh();
+        PERF_Record(&span, PERF_CYCLES() - start);
+        
+        start = PERF_CYCLES();
+        OLED_RefreshBytewise();
+        PERF_Record(&bytewise, PERF_CYCLES() - start);
+    }
+    
+    PERF_Print("oled bytewise frame", &bytewise);
+    PERF_Print("oled span frame", &span);
+    PERF_Print("oled page cpu", &page_cpu);
+    PERF_Print("oled page total", &page_total);
+    
+    // 写屏量：清屏后完整重绘一次水位页面，再分别按两种方式整屏重发
+    OLED_Clear();
+    OLED_Invalidate();
+    OLED_ResetStats();
+    WATER_DisplayWaterPage();
+    OLED_Refresh();
+    WATER_PrintOledStat("oled page redraw");
+    
+    OLED_Invalidate();
+    OLED_ResetStats();
+    OLED_Refresh();
+    WATER_PrintOledStat("oled span frame");
+    
+    OLED_ResetStats();
+    OLED_RefreshBytewise();
+    WATER_PrintOledStat("oled bytewise frame");
+    
+    // 帧率上限：每帧都整屏重发，只计DMA刷新本身
+    PERF_Stat_TypeDef fps_stat[2];
+    const char *fps_name[2] = {"pages", "full"};
+    char label[24];
+    
+    for (uint8_t m = 0; m < 2; m++)
+    {
+        PERF_Reset(&fps_stat[m]);
+        OLED_SetFlushMode(m == 0 ? OLED_FLUSH_PAGES : OLED_FLUSH_FULL);
+        for (uint8_t r = 0; r < OLED_BENCH_FPS_FRAMES; r++)
+        {
+            OLED_Invalidate();
+            OLED_ResetStats();
+            start = PERF_CYCLES();
+            OLED_Refresh();
+            PERF_Record(&fps_stat[m], PERF_CYCLES() - start);
+        }
+        sprintf(label, "oled %s frame", fps_name[m]);
+        PERF_Print(label, &fps_stat[m]);
+        WATER_PrintOledStat(label);
+        SEGGER_RTT_printf(0, "oled %s max fps=%u\n", fps_name[m],
+                          SystemCoreClock / PERF_Average(&fps_stat[m]));
+    }
+    OLED_SetFlushMode(OLED_FLUSH_AUTO);
+    
+    // 单独重绘一次水位页面，输出这一帧的写屏字节数、传输次数和DC切换次数
+    OLED_Stat_TypeDef stat;
+    OLED_Clear();
+    WATER_DisplayWaterPage();
+    OLED_Refresh();
+    OLED_GetStats(&stat);
+    SEGGER_RTT_printf(0, "oled water page frame bytes=%u xfers=%u dc=%u\n",
+                      stat.frame_bytes, stat.frame_transfers, stat.frame_dc_toggles);
+#ifdef OLED_MIRROR
+    SEGGER_RTT_printf(0, "oled mirror diff=%u\n", OLED_MirrorCheck());
+#endif
 }
+#endif
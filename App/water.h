@@ -6,22 +6,151 @@
 #include "oled.h"
 #include "rtc.h"
 #include "flash.h"
+#include "filter.h"
+#include "trend.h"
+#include "scene.h"
+#include "history.h"
 
-// 定义ADC采样缓冲区大小
+// 定义ADC采样缓冲区大小(每个通道每次处理的样本数)
 #define ADC_BUFFER_SIZE 100
 
+// 半区大小，扫描模式下各通道样本按帧交错存放
+#define ADC_HALF_SIZE (ADC_BUFFER_SIZE * WATER_CHANNELS)
+
+// DMA循环缓冲区分为前后两半(乒乓缓冲)，DMA填充一半时处理另一半
+#define ADC_DMA_BUFFER_SIZE (ADC_HALF_SIZE * 2)
+
+// 水位通道0~3对应的ADC通道(PA5/PA6/PA7/PB0)，WATER_CHANNELS决定使用前几个
+#define WATER_ADC_CHANNELS { ADC_CHANNEL_5, ADC_CHANNEL_6, ADC_CHANNEL_7, ADC_CHANNEL_8 }
+
+// ADC采样模式
+#define WATER_ADC_CONTINUOUS 0  // 连续转换，1.5周期采样，约857k次/秒
+#define WATER_ADC_TIMER      1  // TIM3 TRGO定时触发，速率可配置
+
+#ifndef WATER_ADC_MODE
+#define WATER_ADC_MODE WATER_ADC_TIMER
+#endif
+
+#if WATER_ADC_MODE == WATER_ADC_TIMER
+// TIM3计数频率(72MHz / 720)，采样率 = WATER_TIMER_CLOCK_HZ / (ARR + 1)，每次触发扫描全部通道
+#define WATER_TIMER_CLOCK_HZ  100000
+// 默认采样率(Hz)
+#define WATER_SAMPLE_RATE_HZ  1000
+// 过采样倍数，每WATER_OVERSAMPLE个原始样本平均抽取为1个，输出速率 = 采样率 / 过采样倍数
+#define WATER_OVERSAMPLE      4
+// 水位探头为高阻抗，采样时间加长到239.5周期(约20us)保证采样电容充满
+#define WATER_SAMPLE_TIME     ADC_SAMPLETIME_239CYCLES_5
+
+// 自适应采样：水位稳定后逐档把采样率减半，处理节奏随半区填满速度同步降低，
+// 任一通道滤波后的ADC值超出死区或水位变化时立即恢复全速
+#ifndef WATER_ADAPTIVE
+#define WATER_ADAPTIVE        1
+#endif
+// 采样率档数，第n档为WATER_SAMPLE_RATE_HZ >> n
+#define WATER_ADAPT_LEVELS    4
+// 连续多少个半区未超出死区才降一档(全速下1个半区为100ms)
+#define WATER_ADAPT_STABLE_BLOCKS 10
+// 死区(ADC码)，相对降档时的参考值
+#define WATER_ADAPT_DEADBAND  8
+#else
+#define WATER_OVERSAMPLE      1
+#define WATER_SAMPLE_TIME     ADC_SAMPLETIME_1CYCLE_5
+// 连续转换模式采样率固定
+#define WATER_ADAPTIVE        0
+#define WATER_ADAPT_LEVELS    1
+#endif
+
+// 滤波方式
+#define WATER_FILTER_BLOCK   0  // 每个半区求一次中位数，水位按块更新
+#define WATER_FILTER_STREAM  1  // 滑动窗口分位数，每个样本更新一次
+
+#ifndef WATER_FILTER_MODE
+#define WATER_FILTER_MODE WATER_FILTER_STREAM
+#endif
+
+// 滑动窗口模式下跟踪的分位数(50为中位数)
+#define WATER_FILTER_PERCENT 50
+
+// 平滑级：中位数/分位数之后再做一级低通
+#define WATER_SMOOTH_IIR     0  // 一阶IIR(EMA)
+#define WATER_SMOOTH_KALMAN  1  // 一维卡尔曼
+
+#ifndef WATER_SMOOTH_MODE
+#define WATER_SMOOTH_MODE WATER_SMOOTH_IIR
+#endif
+
+// IIR平滑系数(Q15)：逐样本模式每秒约250个样本取1/16，按块模式每块1个样本取1/2
+#if WATER_FILTER_MODE == WATER_FILTER_STREAM
+#define WATER_IIR_ALPHA      2048
+#else
+#define WATER_IIR_ALPHA      16384
+#endif
+
+// 卡尔曼噪声方差(Q16，单位ADC码^2)：过程噪声1/16，测量噪声16
+#define WATER_KALMAN_Q       (FILTER_Q16(1) / 16)
+#define WATER_KALMAN_R       FILTER_Q16(16)
+
+// 水位量化步长1%，回差0.25%，防止临界值附近来回跳变
+#define WATER_HYST_STEP      FILTER_Q16(1)
+#define WATER_HYST_BAND      (FILTER_Q16(1) / 4)
+
+#if (ADC_BUFFER_SIZE % WATER_OVERSAMPLE) != 0
+#error "ADC_BUFFER_SIZE must be a multiple of WATER_OVERSAMPLE"
+#endif
+
+#if (ADC_BUFFER_SIZE / WATER_OVERSAMPLE) > FILTER_MAX_BLOCK
+#error "decimated block must fit in FILTER_MAX_BLOCK"
+#endif
+
+// 报警方式
+#define WATER_ALARM_POLL      0 // 滤波后的水位达到阈值才报警
+#define WATER_ALARM_WATCHDOG  1 // ADC模拟看门狗中断立即报警，滤波后的水位随后确认
+
+#ifndef WATER_ALARM_MODE
+#define WATER_ALARM_MODE WATER_ALARM_WATCHDOG
+#endif
+
+// 看门狗报警后等待滤波确认时平滑级的余量(ms)，再加上当前采样率下半区和滑动窗口的延迟，
+// 超时视为干扰并重新布防
+#define WATER_ALARM_CONFIRM_MS 500
+
+// 趋势估计：每隔WATER_TREND_INTERVAL_MS取一次标定后的水位(回差量化前)，
+// 最近TREND_SIZE个样本最小二乘拟合上涨速率，预计到达阈值的时间短于提前量时预警
+#define WATER_TREND_INTERVAL_MS 1000
+
+// 历史曲线：每桶时长，HISTORY_SIZE个桶覆盖最近1小时，样本取自趋势采样
+#define WATER_HISTORY_BUCKET_MS (3600000UL / HISTORY_SIZE)
+#ifndef WATER_TREND_LEAD_S
+#define WATER_TREND_LEAD_S      60
+#endif
+// 上涨速率低于此值(Q16 %/秒，约0.6%/分钟)视为平稳，不预警
+#define WATER_TREND_MIN_RATE    (FILTER_Q16(1) / 100)
+
 // 定义页面切换时间(ms)
 #define PAGE_SWITCH_TIME 5000
 
+// 定时轮换页面时的过渡方式(OLED_TRANS_NONE/SLIDE/FADE)，水位变化和报警切换始终直接切换
+#ifndef WATER_PAGE_TRANSITION
+#define WATER_PAGE_TRANSITION OLED_TRANS_SLIDE
+#endif
+
 // 定义水位稳定计数阈值
 #define WATER_STABLE_COUNT 5
 
 // 页面枚举类型
 typedef enum {
     PAGE_WATER,     // 水位信息页面
-    PAGE_TIME       // 时间信息页面
+    PAGE_TIME,      // 时间信息页面
+    PAGE_HISTORY    // 水位历史曲线页面
 } DisplayPage_TypeDef;
 
+// 报警状态
+typedef enum {
+    WATER_ALARM_ARMED,      // 已布防，等待看门狗中断(或轮询模式下等待水位达到阈值)
+    WATER_ALARM_PENDING,    // 看门狗已触发，等待滤波后的水位确认
+    WATER_ALARM_ACTIVE      // 已确认，水位回落到阈值以下后重新布防
+} WaterAlarm_TypeDef;
+
 // 水位检测状态
 typedef enum {
     WATER_INIT,             // 初始化状态
@@ -32,15 +161,32 @@ typedef enum {
 // 函数声明
 void WATER_Init(void);
 void WATER_Process(void);
-uint8_t WATER_GetLevel(uint16_t adc_value);
+uint8_t WATER_GetLevel(uint8_t channel, uint16_t adc_value);
 void WATER_DisplayLevel(uint8_t level, uint8_t force_update);
 void WATER_DisplayWaterPage(void);
 void WATER_DisplayTimePage(RTC_TimeTypeDef *time);
+void WATER_DisplayHistoryPage(void);
 void WATER_PageManager(void);
 void WATER_SwitchPage(DisplayPage_TypeDef page);
-uint8_t WATER_GetCurrentLevel(void);
+uint8_t WATER_GetCurrentLevel(uint8_t channel);
+uint32_t WATER_GetOverrunCount(void);
+uint16_t WATER_GetPercentile(uint8_t channel, uint8_t percent);
+int32_t WATER_GetRiseRate(uint8_t channel);
+uint32_t WATER_GetTimeToThreshold(uint8_t channel);
+uint8_t WATER_IsRiseWarning(uint8_t channel);
+void WATER_SetSampleRate(uint16_t rate_hz);
+uint16_t WATER_GetSampleRate(void);
+uint8_t WATER_GetRateLevel(void);
+uint32_t WATER_GetRateDwell(uint8_t level);
+void WATER_RecordIrqCycles(uint32_t cycles);
+void WATER_ReportPerf(void);
+
+#ifdef OLED_BENCHMARK
+void WATER_DisplayBenchmark(void);
+#endif
 
 // 回调函数声明
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef* hadc);
 void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef* hadc);
 
 // 添加函数声明
@@ -49,5 +195,9 @@ uint8_t WATER_IsPageLocked(void);
 
 // 添加报警功能相关的声明
 void WATER_CheckAlarm(void);
+void WATER_RearmAlarm(uint8_t channel);
+WaterAlarm_TypeDef WATER_GetAlarmState(uint8_t channel);
+void WATER_AlarmIrqEnter(uint32_t cycles);
+void HAL_ADC_LevelOutOfWindowCallback(ADC_HandleTypeDef* hadc);
 
 #endif /* __WATER_H */
@@ -0,0 +1,148 @@
+#include "window.h"
+#include <string.h>
+
+/**
+  * @brief  分位数对应的序号(0起)
+  * @param  count: 样本数
+  * @param  percent: 分位数(0-100)
+  * @retval 序号
+  */
+static uint16_t WINDOW_Rank(uint16_t count, uint8_t percent)
+{
+    return (uint32_t)(count - 1) * percent / 100;
+}
+
+/**
+  * @brief  细格编号换算回ADC值(取格中心)
+  * @param  bin: 细格编号
+  * @retval ADC值
+  */
+static uint16_t WINDOW_BinValue(uint16_t bin)
+{
+    return (bin << WINDOW_BIN_SHIFT) + ((1 << WINDOW_BIN_SHIFT) >> 1);
+}
+
+/**
+  * @brief  初始化滑动窗口滤波器
+  * @param  win: 滤波器指针
+  * @param  percent: WINDOW_Get跟踪的分位数(50为中位数)
+  * @retval None
+  */
+void WINDOW_Init(WINDOW_TypeDef *win, uint8_t percent)
+{
+    memset(win, 0, sizeof(WINDOW_TypeDef));
+    win->percent = (percent > 100) ? 100 : percent;
+}
+
+/**
+  * @brief  加入一个新样本，窗口满时同时移出最旧样本
+  * @param  win: 滤波器指针
+  * @param  sample: 12位ADC样本
+  * @retval None
+  * @note   O(1)：只更新两个细格、两个粗格计数以及游标下方计数
+  */
+void WINDOW_Push(WINDOW_TypeDef *win, uint16_t sample)
+{
+    uint16_t bin = (sample >> WINDOW_BIN_SHIFT) & (WINDOW_BINS - 1);
+
+    if (win->count == WINDOW_SIZE)
+    {
+        // 移出最旧样本(即将被覆盖的位置)
+        uint16_t old = win->ring[win->head];
+        win->hist[old]--;
+        win->group[old >> WINDOW_GROUP_SHIFT]--;
+        if (old < win->cursor)
+        {
+            win->below--;
+        }
+    }
+    else
+    {
+        win->count++;
+    }
+
+    win->ring[win->head] = bin;
+    win->hist[bin]++;
+    win->group[bin >> WINDOW_GROUP_SHIFT]++;
+    if (bin < win->cursor)
+    {
+        win->below++;
+    }
+
+    if (++win->head >= WINDOW_SIZE)
+    {
+        win->head = 0;
+    }
+}
+
+/**
+  * @brief  获取跟踪的分位数
+  * @param  win: 滤波器指针
+  * @retval ADC值，窗口为空时返回0
+  * @note   游标只在相邻细格间移动，信号缓慢变化时均摊O(1)
+  */
+uint16_t WINDOW_Get(WINDOW_TypeDef *win)
+{
+    uint16_t rank;
+
+    if (win->count == 0)
+    {
+        return 0;
+    }
+
+    rank = WINDOW_Rank(win->count, win->percent);
+
+    // 目标在游标下方，向下移动
+    while (win->below > rank)
+    {
+        win->cursor--;
+        win->below -= win->hist[win->cursor];
+    }
+
+    // 目标在游标上方，向上移动
+    while (win->below + win->hist[win->cursor] <= rank)
+    {
+        win->below += win->hist[win->cursor];
+        win->cursor++;
+    }
+
+    return WINDOW_BinValue(win->cursor);
+}
+
+/**
+  * @brief  查询任意分位数
+  * @param  win: 滤波器指针
+  * @param  percent: 分位数(0-100)
+  * @retval ADC值，窗口为空时返回0
+  * @note   先扫描粗格再扫描细格，最多WINDOW_GROUPS + 32次比较，不移动游标
+  */
+uint16_t WINDOW_Percentile(const WINDOW_TypeDef *win, uint8_t percent)
+{
+    uint16_t rank, below = 0;
+    uint16_t g, bin;
+
+    if (win->count == 0)
+    {
+        return 0;
+    }
+
+    rank = WINDOW_Rank(win->count, (percent > 100) ? 100 : percent);
+
+    for (g = 0; g < WINDOW_GROUPS - 1; g++)
+    {
+        if (below + win->group[g] > rank)
+        {
+            break;
+        }
+        below += win->group[g];
+    }
+
+    bin = g << WINDOW_GROUP_SHIFT;
+    while (below + win->hist[bin] <= rank)
+    {
+        below += win->hist[bin];
+        bin++;
+    }
+
+    return WINDOW_BinValue(bin);
+}
@@ -0,0 +1,39 @@
+#ifndef __WINDOW_H
+#define __WINDOW_H
+
+#include "main.h"
+
+// 滑动窗口长度(样本数)，计数器为8位，不能超过255
+#define WINDOW_SIZE         128
+
+// 直方图量化：12位ADC值右移2位，1024个细格，每格4个ADC码
+#define WINDOW_BIN_SHIFT    2
+#define WINDOW_BINS         (4096 >> WINDOW_BIN_SHIFT)
+
+// 每32个细格合为一个粗格，任意分位数查询只需扫描32个粗格+32个细格
+#define WINDOW_GROUP_SHIFT  5
+#define WINDOW_GROUPS       (WINDOW_BINS >> WINDOW_GROUP_SHIFT)
+
+#if WINDOW_SIZE > 255
+#error "WINDOW_SIZE must fit in 8-bit histogram counters"
+#endif
+
+// 滑动窗口分位数滤波器
+typedef struct {
+    uint16_t ring[WINDOW_SIZE];     // 窗口内样本(细格编号)，按时间顺序环形存放
+    uint8_t hist[WINDOW_BINS];      // 细格计数
+    uint8_t group[WINDOW_GROUPS];   // 粗格计数
+    uint16_t head;                  // 下一个写入位置
+    uint16_t count;                 // 窗口内样本数
+    uint16_t cursor;                // 跟踪分位数当前所在细格
+    uint16_t below;                 // 小于cursor细格的样本数
+    uint8_t percent;                // 跟踪的分位数(0-100)
+} WINDOW_TypeDef;
+
+// 函数声明
+void WINDOW_Init(WINDOW_TypeDef *win, uint8_t percent);
+void WINDOW_Push(WINDOW_TypeDef *win, uint16_t sample);
+uint16_t WINDOW_Get(WINDOW_TypeDef *win);
+uint16_t WINDOW_Percentile(const WINDOW_TypeDef *win, uint8_t percent);
+
+#endif /* __WINDOW_H */
@@ -41,6 +41,7 @@ extern ADC_HandleTypeDef hadc1;
 void MX_ADC1_Init(void);
 
 /* USER CODE BEGIN Prototypes */
+HAL_StatusTypeDef ADC1_ConfigTrigger(uint32_t trigger, const uint32_t *channels, uint8_t count, uint32_t sampling_time);
 
 /* USER CODE END Prototypes */
 
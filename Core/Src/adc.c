@@ -107,6 +107,9 @@ void HAL_ADC_MspInit(ADC_HandleTypeDef* adcHandle)
 
     __HAL_LINKDMA(adcHandle,DMA_Handle,hdma_adc1);
 
+    /* ADC1 interrupt Init */
+    HAL_NVIC_SetPriority(ADC1_2_IRQn, 5, 0);
+    HAL_NVIC_EnableIRQ(ADC1_2_IRQn);
   /* USER CODE BEGIN ADC1_MspInit 1 */
 
   /* USER CODE END ADC1_MspInit 1 */
@@ -131,6 +134,9 @@ void HAL_ADC_MspDeInit(ADC_HandleTypeDef* adcHandle)
 
     /* ADC1 DMA DeInit */
     HAL_DMA_DeInit(adcHandle->DMA_Handle);
+
+    /* ADC1 interrupt Deinit */
+    HAL_NVIC_DisableIRQ(ADC1_2_IRQn);
   /* USER CODE BEGIN ADC1_MspDeInit 1 */
 
   /* USER CODE END ADC1_MspDeInit 1 */
@@ -138,5 +144,71 @@ void HAL_ADC_MspDeInit(ADC_HandleTypeDef* adcHandle)
 }
 
 /* USER CODE BEGIN 1 */
+/**
+  * @brief  把ADC通道对应的引脚配置为模拟输入
+  * @param  channel: ADC_CHANNEL_0~ADC_CHANNEL_9
+  * @retval None
+  * @note   IN0~IN7对应PA0~PA7，IN8~IN9对应PB0~PB1
+  */
+static void ADC1_ConfigChannelPin(uint32_t channel)
+{
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+  GPIO_InitStruct.Mode = GPIO_MODE_ANALOG;
+  if (channel <= ADC_CHANNEL_7)
+  {
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    GPIO_InitStruct.Pin = GPIO_PIN_0 << channel;
+    HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+  }
+  else if (channel <= ADC_CHANNEL_9)
+  {
+    __HAL_RCC_GPIOB_CLK_ENABLE();
+    GPIO_InitStruct.Pin = GPIO_PIN_0 << (channel - ADC_CHANNEL_8);
+    HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+  }
+}
+
+/**
+  * @brief  重新配置ADC1的触发方式、转换序列和采样时间
+  * @param  trigger: ADC_SOFTWARE_START(连续转换)或ADC_EXTERNALTRIGCONV_xxx(外部触发)
+  * @param  channels: 转换序列中的ADC通道，按顺序依次转换
+  * @param  count: 通道数(1~16)，多于1个时开启扫描模式，每次触发转换整个序列
+  * @param  sampling_time: 各通道采样时间
+  * @retval HAL状态
+  * @note   需在HAL_ADC_Start_DMA之前调用，DMA缓冲区内各通道结果按序列顺序交错存放
+  */
+HAL_StatusTypeDef ADC1_ConfigTrigger(uint32_t trigger, const uint32_t *channels, uint8_t count, uint32_t sampling_time)
+{
+  ADC_ChannelConfTypeDef sConfig = {0};
+
+  if (count == 0 || count > 16)
+  {
+    return HAL_ERROR;
+  }
+
+  hadc1.Init.ScanConvMode = (count > 1) ? ADC_SCAN_ENABLE : ADC_SCAN_DISABLE;
+  hadc1.Init.ContinuousConvMode = (trigger == ADC_SOFTWARE_START) ? ENABLE : DISABLE;
+  hadc1.Init.ExternalTrigConv = trigger;
+  hadc1.Init.NbrOfConversion = count;
+  if (HAL_ADC_Init(&hadc1) != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+
+  for (uint8_t i = 0; i < count; i++)
+  {
+    ADC1_ConfigChannelPin(channels[i]);
+
+    sConfig.Channel = channels[i];
+    sConfig.Rank = ADC_REGULAR_RANK_1 + i;
+    sConfig.SamplingTime = sampling_time;
+    if (HAL_ADC_ConfigChannel(&hadc1, &sConfig) != HAL_OK)
+    {
+      return HAL_ERROR;
+    }
+  }
 
+  return HAL_OK;
+}
 /* USER CODE END 1 */
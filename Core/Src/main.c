@@ -34,6 +34,10 @@
 #include "water.h"
 #include "flash.h"
 #include "4G.h"
+#include "perf.h"
+#include "median.h"
+#include "calib.h"
+#include "json.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -103,19 +107,24 @@ int main(void)
   MX_SPI2_Init();
   MX_USART2_UART_Init();
   MX_TIM2_Init();
+  MX_TIM3_Init();
   /* USER CODE BEGIN 2 */
   OLED_Init();
   OLED_ShowString(0, 2, "Device Initializing...", 16);
+  OLED_Refresh();
 
   SEGGER_RTT_ConfigUpBuffer(0, NULL, NULL, 0, SEGGER_RTT_MODE_BLOCK_IF_FIFO_FULL);
 
+  PERF_Init(); // 初始化DWT周期计数器
   TIMER_Start(); // 初始化定时器
   G4_Init(); // 初始化4G模块
   FLASH_Init(); // 初始化Flash参数存储
+  CALIB_Init(); // 载入水位标定表
   
   // 初始化RTC
   if (PCF8563_Init() != HAL_OK) {
     OLED_ShowString(0, 2, "RTC Init Failed!", 16);
+    OLED_Refresh();
     Error_Handler();
   }
   
@@ -131,9 +140,25 @@ int main(void)
   PCF8563_SetTime(&rtcTime);
   */
 
-  G4_GetWeather(); // 获取天气数据
-  G4_InitMQTT(1); // 初始化MQTT
+#ifdef MEDIAN_BENCHMARK
+  MEDIAN_Benchmark(); // 中位数算法基准测试，结果通过RTT输出
+#endif
+#ifdef CALIB_BENCHMARK
+  CALIB_Benchmark(); // 标定查表单调性自检与耗时测试
+#endif
+#ifdef RING_BENCHMARK
+  RING_Benchmark(); // 接收环形缓冲区突发写入压力测试：吞吐、丢失与数据校验
+#endif
+#ifdef JSON_BENCHMARK
+  JSON_Benchmark(); // 天气JSON字段提取：strstr逐字段扫描与流式解析对比
+#endif
+
+  G4_GetWeather(); // 开始获取天气数据，结束后自动连接MQTT，由G4_ProcessData推进
   WATER_Init(); // 初始化水位检测
+#ifdef OLED_BENCHMARK
+  OLED_FontBenchmark(); // 压缩字模解码和绘制耗时
+  WATER_DisplayBenchmark(); // 水位页面整屏重绘耗时：逐字节写屏与按页DMA写屏对比
+#endif
   
   /* USER CODE END 2 */
 
@@ -145,27 +170,30 @@ int main(void)
 
     /* USER CODE BEGIN 3 */
 
-    // 如果MQTT未连接但4G已连接，尝试初始化MQTT
-    if (g4_mqtt_state == MQTT_DISCONNECTED) {
-        G4_InitMQTT(0);
-    } 
     // 定时上传数据
-    else if (g4_upload_flag == 1) {
+    if (g4_mqtt_state == MQTT_CONNECTED && g4_upload_flag == 1) {
       g4_upload_flag = 0;
       G4_UploadData();
     }
 
-     // 处理4G数据
+     // 处理4G数据，推进天气请求和MQTT连接，不阻塞
     G4_ProcessData();
 
     // 水位检测ADC
     WATER_Process();
 
+    // 刷新期间新绘制的内容在上一次DMA刷新结束后补写
+    OLED_StartFlush();
+
     // 1s定时器中断
     if (timer_1s_flag)
     {
         timer_1s_flag = 0;
         HAL_GPIO_TogglePin(LED_GPIO_Port, LED_Pin);
+
+#ifdef WATER_PERF_REPORT
+        WATER_ReportPerf(); // 输出ADC采集开销，用于比较连续/定时触发两种模式
+#endif
         
         // 如果当前是时间页面，则更新时间显示
         if (WATER_GetCurrentPage() == PAGE_TIME && !WATER_IsPageLocked())
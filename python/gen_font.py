@@ -0,0 +1,224 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+压缩字库生成脚本：从App/oledfont.h读取原始字模，生成App/oledfont_pack.h
+用法: python gen_font.py [--literal-only]
+
+- 扫描App和Core/Src下的源文件，只保留固件实际用到的字库：
+  OLED_ShowString/OLED_ShowChar/SCENE_InitLabel的字体大小参数决定是否需要6x8和8x16字库，
+  OLED_ShowChinese的索引参数决定保留哪些汉字
+- ASCII字库默认保留全部可打印字符(城市、天气等文本来自网络，内容不确定)，
+  --literal-only只保留源码字符串常量中出现的字符和数字
+- 每个字模：非零字节掩码 + 非零字节的4位码字(15项字典，0x0F转义后跟原始字节)
+- 8x16字库另外生成每个字模的起始列和宽度，用于比例宽度显示；数字取相同宽度，时间跳动时不会左右晃动
+"""
+
+import os
+import re
+import sys
+from collections import Counter
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SRC_DIRS = [os.path.join(ROOT, 'App'), os.path.join(ROOT, 'Core', 'Src')]
+FONT_SRC = os.path.join(ROOT, 'App', 'oledfont.h')
+FONT_OUT = os.path.join(ROOT, 'App', 'oledfont_pack.h')
+ESCAPE = 0x0F
+SPACE_WIDTH = 3     # 空格宽度(列)
+
+
+def read_tables():
+    """读取oledfont.h中的F6x8、F8X16、Hzk原始字模"""
+    with open(FONT_SRC, 'r', encoding='latin-1') as f:
+        text = f.read()
+
+    def table(name, glyph_size):
+        start = text.index(name)
+        body = text[text.index('{', start) + 1:text.index('};', start)]
+        body = re.sub(r'//[^\n]*', '', body)
+        body = re.sub(r'/\*.*?\*/', '', body, flags=re.S)
+        values = [int(v, 16) for v in re.findall(r'0x([0-9A-Fa-f]{2})', body)]
+        return [values[i:i + glyph_size] for i in range(0, len(values), glyph_size)]
+
+    return table('F6x8', 6), table('F8X16', 16), table('Hzk', 32)
+
+
+def scan_sources():
+    """扫描源文件，返回(用到的字体大小, 用到的汉字索引, 字符串常量中的字符)"""
+    sizes, hanzi, chars = set(), set(), set()
+    for d in SRC_DIRS:
+        for name in os.listdir(d):
+            if not name.endswith('.c') or name in ('oled.c', 'scene.c'):
+                continue
+            with open(os.path.join(d, name), 'r', encoding='utf-8', errors='ignore') as f:
+                code = f.read()
+            for m in re.finditer(r'(OLED_ShowString|OLED_ShowChar|SCENE_InitLabel)\s*\(([^;]*)\)\s*;', code):
+                arg = m.group(2).split(',')[-1].strip()
+                if arg.isdigit():
+                    sizes.add(int(arg))
+            for m in re.finditer(r'OLED_ShowChinese\s*\(([^;]*)\)\s*;', code):
+                arg = m.group(1).split(',')[-1].strip()
+                if arg.isdigit():
+                    hanzi.add(int(arg))
+            for m in re.finditer(r'"((?:[^"\\\n]|\\.)*)"', code):
+                chars.update(c for c in m.group(1) if ' ' <= c <= '~')
+    return sizes, hanzi, chars
+
+
+def encode(glyphs, dictionary):
+    """压缩一组字模，返回(数据, 各字模偏移)"""
+    data, index = [], []
+    for g in glyphs:
+        index.append(len(data))
+        mask = [0] * ((len(g) + 7) // 8)
+        nibbles = []
+        for i, v in enumerate(g):
+            if v == 0:
+                continue
+            mask[i >> 3] |= 1 << (i & 7)
+            if v in dictionary:
+                nibbles.append(dictionary.index(v))
+            else:
+                nibbles += [ESCAPE, v >> 4, v & 0x0F]
+        if len(nibbles) % 2:
+            nibbles.append(0)
+        data += mask
+        data += [(nibbles[i] << 4) | nibbles[i + 1] for i in range(0, len(nibbles), 2)]
+    return data, index
+
+
+def decode(data, offset, size, dictionary):
+    """按FONT_Decode相同的规则解码一个字模，用于自检"""
+    mask_bytes = (size + 7) // 8
+    mask = data[offset:offset + mask_bytes]
+    nibbles = []
+    for b in data[offset + mask_bytes:]:
+        nibbles += [b >> 4, b & 0x0F]
+    out, k = [], 0
+    for i in range(size):
+        if not mask[i >> 3] & (1 << (i & 7)):
+            out.append(0)
+            continue
+        c = nibbles[k]
+        k += 1
+        if c == ESCAPE:
+            out.append((nibbles[k] << 4) | nibbles[k + 1])
+            k += 2
+        else:
+            out.append(dictionary[c])
+    return out
+
+
+def metrics(glyphs, first, width, pages):
+    """计算每个字模的(起始列, 宽度)，打包为(起始列 << 4) | 宽度"""
+    spans = []
+    for g in glyphs:
+        cols = [c for c in range(width) if any(g[p * width + c] for p in range(pages))]
+        spans.append((cols[0], cols[-1]) if cols else None)
+
+    # 数字统一为所有数字的列范围并集
+    digits = [spans[ord(c) - first] for c in '0123456789'
+              if 0 <= ord(c) - first < len(spans) and spans[ord(c) - first]]
+    if digits:
+        union = (min(s[0] for s in digits), max(s[1] for s in digits))
+        for c in '0123456789':
+            if 0 <= ord(c) - first < len(spans):
+                spans[ord(c) - first] = union
+
+    packed = []
+    for span in spans:
+        if span is None:
+            packed.append(SPACE_WIDTH)  # 空白字模(空格)
+        else:
+            packed.append((span[0] << 4) | (span[1] - span[0] + 1))
+    return packed
+
+
+def emit(name, glyphs, first, width, pages, proportional=False):
+    """生成一个压缩字库的C代码，返回(代码行, 压缩后字节数)"""
+    counts = Counter(v for g in glyphs for v in g if v)
+    dictionary = [v for v, _ in counts.most_common(15)]
+    dictionary += [0] * (15 - len(dictionary))
+    data, index = encode(glyphs, dictionary)
+    for g, off in zip(glyphs, index):
+        assert decode(data, off, width * pages, dictionary) == g, name
+
+    lines = ['static const uint8_t %s_Dict[15] = {%s};' % (name, ', '.join('0x%02X' % v for v in dictionary)),
+             'static const uint16_t %s_Index[%d] = {' % (name, len(index))]
+    for i in range(0, len(index), 12):
+        lines.append('    ' + ', '.join(str(v) for v in index[i:i + 12]) + ',')
+    lines.append('};')
+    lines.append('static const uint8_t %s_Data[%d] = {' % (name, len(data)))
+    for i in range(0, len(data), 16):
+        lines.append('    ' + ','.join('0x%02X' % v for v in data[i:i + 16]) + ',')
+    lines.append('};')
+    size = 15 + 2 * len(index) + len(data)
+    if proportional:
+        m = metrics(glyphs, first, width, pages)
+        lines.append('static const uint8_t %s_Metrics[%d] = {' % (name, len(m)))
+        for i in range(0, len(m), 16):
+            lines.append('    ' + ','.join('0x%02X' % v for v in m[i:i + 16]) + ',')
+        lines.append('};')
+        size += len(m)
+        metrics_name = name + '_Metrics'
+    else:
+        metrics_name = 'NULL'
+    lines.append('static const FONT_TypeDef %s = {%d, %d, %d, %d, %s_Dict, %s_Index, %s_Data, %s};'
+                 % (name, first, len(glyphs), width, pages, name, name, name, metrics_name))
+    return lines, size
+
+
+def main():
+    literal_only = '--literal-only' in sys.argv
+    f6x8, f8x16, hzk = read_tables()
+    sizes, hanzi, chars = scan_sources()
+
+    if literal_only:
+        chars.update('0123456789 ')
+        keep = lambda c: c in chars
+    else:
+        keep = lambda c: True
+
+    def ascii_font(glyphs):
+        # 连续区间[first, last]内未用到的字符置空，保持按字符直接索引
+        used = [i for i in range(len(glyphs)) if keep(chr(32 + i))]
+        first, last = used[0], used[-1]
+        return [glyphs[i] if keep(chr(32 + i)) else [0] * len(glyphs[i]) for i in range(first, last + 1)], 32 + first
+
+    out = ['#ifndef __OLEDFONT_PACK_H',
+           '#define __OLEDFONT_PACK_H',
+           '',
+           '// 由python/gen_font.py从oledfont.h生成，请勿手工修改',
+           '',
+           '#include "font.h"',
+           '']
+    packed = 0
+
+    for size, glyphs, name, width, pages in ((8, f6x8, 'Font6x8', 6, 1), (16, f8x16, 'Font8x16', 8, 2)):
+        macro = 'FONT_HAS_%s' % name[4:].upper()
+        if size not in sizes:
+            out += ['#define %s 0' % macro, '']
+            continue
+        subset, first = ascii_font(glyphs)
+        lines, n = emit(name, subset, first, width, pages, proportional=(size == 16))
+        packed += n
+        out += ['#define %s 1' % macro] + lines + ['']
+
+    if hanzi:
+        # 保留用到的汉字，索引0..max连续存放，未用到的置空
+        subset = [hzk[i] if i in hanzi else [0] * 32 for i in range(max(hanzi) + 1)]
+        lines, n = emit('FontHzk', subset, 0, 16, 2)
+        packed += n
+        out += ['#define FONT_HAS_HZK 1'] + lines + ['']
+    else:
+        out += ['#define FONT_HAS_HZK 0', '']
+
+    out += ['#endif /* __OLEDFONT_PACK_H */', '']
+    with open(FONT_OUT, 'w', encoding='utf-8') as f:
+        f.write('\n'.join(out))
+
+    print('font sizes used: %s, hanzi used: %s' % (sorted(sizes), sorted(hanzi)))
+    print('glyph data: %d bytes raw (all tables) -> %d bytes packed' % (len(f6x8) * 6 + len(f8x16) * 16 + len(hzk) * 32, packed))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,54 @@
+#!/usr/bin/env python3
+"""生成test/data/fill_1khz.txt：单通道原始ADC码，1kHz，一行一个样本。
+
+这是按实际水箱现象合成的数据，不是板上录制的：
+  0~3s    25%左右静止，白噪声
+  3~11s   进水，水位由约25%涨到约80%，按默认标定表换算成ADC码
+  11~16s  停泵后水面晃动，衰减振荡
+  全程    水泵干扰造成的单点尖峰和偶发的掉零
+板上录制的数据(RTT输出的ADC码，一行一个)可以直接替换该文件，格式相同。
+"""
+import math
+import random
+
+RATE = 1000
+SECONDS = 16
+# App/calib.c的默认标定表
+CALIB = [(220, 0), (270, 10), (320, 20), (380, 30), (430, 40), (500, 50),
+         (600, 60), (830, 70), (1150, 80), (1800, 90), (2450, 100)]
+
+
+def level_to_adc(level):
+    for (a0, p0), (a1, p1) in zip(CALIB, CALIB[1:]):
+        if level <= p1:
+            return a0 + (a1 - a0) * (level - p0) / (p1 - p0)
+    return CALIB[-1][0]
+
+
+def main():
+    rnd = random.Random(20251017)
+    out = ["# fill_1khz: synthetic single-channel ADC trace, %d Hz, %d s (see make_fill_trace.py)"
+           % (RATE, SECONDS)]
+    for n in range(RATE * SECONDS):
+        t = n / RATE
+        if t < 3:
+            level = 25
+        elif t < 11:
+            level = 25 + 55 * (t - 3) / 8
+        else:
+            level = 80
+        adc = level_to_adc(level)
+        if t >= 11:
+            adc += 25 * math.exp(-(t - 11) / 1.5) * math.sin(2 * math.pi * 2 * (t - 11))
+        adc += rnd.gauss(0, 6)
+        if rnd.random() < 0.002:
+            adc += rnd.choice((600, 900, 1500))
+        elif rnd.random() < 0.0005:
+            adc = 0
+        out.append(str(max(0, min(4095, int(round(adc))))))
+    with open("fill_1khz.txt", "w") as f:
+        f.write("\n".join(out) + "\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,73 @@
+#include "main.h"
+#include "flash.h"
+#include <string.h>
+
+/*
+ * 参数页替身：与App/flash.c接口相同，内容保存在内存中，初始为擦除状态(0xFF)。
+ * App/flash.c直接按地址读取片上Flash，不能在主机上运行，测试链接本文件代替它。
+ */
+
+static uint16_t stub_flash[FLASH_PARAM_PAGE_SIZE / 2];
+static uint8_t stub_flash_ready = 0;
+
+static uint16_t *STUB_FlashWord(uint32_t address)
+{
+    if (!stub_flash_ready)
+    {
+        memset(stub_flash, 0xFF, sizeof(stub_flash));
+        stub_flash_ready = 1;
+    }
+    return &stub_flash[(address - FLASH_PARAM_ADDR) / 2];
+}
+
+HAL_StatusTypeDef FLASH_Init(void)
+{
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef FLASH_ReadParam(uint32_t address, uint16_t *data)
+{
+    if (address < FLASH_PARAM_ADDR || address >= FLASH_PARAM_ADDR + FLASH_PARAM_PAGE_SIZE)
+    {
+        return HAL_ERROR;
+    }
+    *data = *STUB_FlashWord(address);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef FLASH_WriteBlock(uint32_t address, const uint16_t *data, uint16_t count)
+{
+    if (address < FLASH_PARAM_ADDR || (address - FLASH_PARAM_ADDR) / 2 + count > FLASH_PARAM_USED_SIZE / 2)
+    {
+        return HAL_ERROR;
+    }
+    memcpy(STUB_FlashWord(address), data, count * 2);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef FLASH_WriteParam(uint32_t address, uint16_t data)
+{
+    return FLASH_WriteBlock(address, &data, 1);
+}
+
+uint16_t FLASH_GetWaterThreshold(uint8_t channel)
+{
+    uint16_t threshold;
+    
+    if (channel >= WATER_CHANNELS ||
+        FLASH_ReadParam(FLASH_PARAM_WATER_THRESHOLD + channel * 2, &threshold) != HAL_OK ||
+        threshold > 100)
+    {
+        return DEFAULT_WATER_THRESHOLD;
+    }
+    return threshold;
+}
+
+HAL_StatusTypeDef FLASH_SetWaterThreshold(uint8_t channel, uint16_t threshold)
+{
+    if (channel >= WATER_CHANNELS)
+    {
+        return HAL_ERROR;
+    }
+    return FLASH_WriteParam(FLASH_PARAM_WATER_THRESHOLD + channel * 2, threshold > 100 ? 100 : threshold);
+}
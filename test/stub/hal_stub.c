@@ -0,0 +1,91 @@
+#include "main.h"
+#include "spi.h"
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * 主机测试用的HAL替身：只实现App模块用到的部分。
+ * SPI的DMA发送立即完成并同步调用完成回调，阻塞等待DMA的代码因此不会卡住。
+ */
+
+uint32_t SystemCoreClock = 1000000000;  // PERF_CYCLES()在主机上以ns计，PERF_CyclesToUs按1GHz换算
+uint32_t stub_tick = 0;
+FILE *stub_rtt = NULL;
+CoreDebug_Type stub_core_debug;
+ADC_TypeDef stub_adc1;
+static DWT_Type stub_dwt;
+
+SPI_HandleTypeDef hspi2 = { .Instance = SPI2 };
+
+DWT_Type *STUB_DWT(void)
+{
+    struct timespec ts;
+    
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    stub_dwt.CYCCNT = (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec);
+    return &stub_dwt;
+}
+
+uint32_t HAL_GetTick(void)
+{
+    return stub_tick;
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+    stub_tick += Delay;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+    (void)GPIOx;
+    (void)GPIO_Pin;
+    (void)PinState;
+}
+
+__attribute__((weak)) void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+    (void)hspi;
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, const uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+    (void)hspi;
+    (void)pData;
+    (void)Size;
+    (void)Timeout;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit_DMA(SPI_HandleTypeDef *hspi, const uint8_t *pData, uint16_t Size)
+{
+    (void)pData;
+    (void)Size;
+    HAL_SPI_TxCpltCallback(hspi);
+    return HAL_OK;
+}
+
+int SEGGER_RTT_printf(unsigned BufferIndex, const char *sFormat, ...)
+{
+    va_list ap;
+    int n;
+    
+    (void)BufferIndex;
+    va_start(ap, sFormat);
+    n = vfprintf(stub_rtt ? stub_rtt : stdout, sFormat, ap);
+    va_end(ap);
+    return n;
+}
+
+unsigned SEGGER_RTT_Write(unsigned BufferIndex, const void *pBuffer, unsigned NumBytes)
+{
+    (void)BufferIndex;
+    return fwrite(pBuffer, 1, NumBytes, stub_rtt ? stub_rtt : stdout);
+}
+
+unsigned SEGGER_RTT_WriteString(unsigned BufferIndex, const char *s)
+{
+    (void)BufferIndex;
+    return fputs(s, stub_rtt ? stub_rtt : stdout) < 0 ? 0 : strlen(s);
+}
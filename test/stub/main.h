@@ -0,0 +1,34 @@
+#ifndef __TEST_MAIN_H
+#define __TEST_MAIN_H
+
+/*
+ * 主机测试用main.h：App/下的模块原样编译，仍使用工程的main.h和HAL头文件，
+ * 只把会被解引用的内核外设(DWT、CoreDebug)换成内存中的替身，屏蔽中断的指令换成空操作。
+ * 外设句柄和HAL函数由test/stub/hal_stub.c提供。
+ */
+#include "../../Core/Inc/main.h"
+#include <stdio.h>
+
+// DWT周期计数器：每次读取时更新为主机单调时钟(ns)，PERF_CYCLES()在主机上的单位为ns
+DWT_Type *STUB_DWT(void);
+extern CoreDebug_Type stub_core_debug;
+#undef DWT
+#define DWT             STUB_DWT()
+#undef CoreDebug
+#define CoreDebug       (&stub_core_debug)
+
+// 被App代码直接读写寄存器的外设换成内存替身(只比较指针的外设如SPI2不需要)
+extern ADC_TypeDef stub_adc1;
+#undef ADC1
+#define ADC1            (&stub_adc1)
+
+#define __disable_irq() ((void)0)
+#define __enable_irq()  ((void)0)
+
+// 主机时钟(ms)，HAL_GetTick返回该值，HAL_Delay使其前进；测试直接修改它模拟时间流逝
+extern uint32_t stub_tick;
+
+// RTT输出重定向到的文件，默认stdout
+extern FILE *stub_rtt;
+
+#endif /* __TEST_MAIN_H */
@@ -0,0 +1,96 @@
+#include "water_stub.h"
+#include "water.h"
+#include "timer.h"
+#include "4G.h"
+
+/*
+ * water.c的外设和相邻模块替身：ADC/DMA/TIM3只记录配置，RTC返回固定时刻，4G状态为已连接。
+ * 测试通过stub_adc_dma_buffer写入样本并调用HAL的ADC回调。
+ */
+
+static TIM_TypeDef stub_tim3;
+DMA_Channel_TypeDef stub_adc_dma_channel;
+static DMA_HandleTypeDef stub_adc_dma = { .Instance = &stub_adc_dma_channel };
+ADC_HandleTypeDef hadc1 = { .Instance = ADC1, .DMA_Handle = &stub_adc_dma };
+TIM_HandleTypeDef htim3 = { .Instance = &stub_tim3 };
+
+uint16_t *stub_adc_dma_buffer;
+uint32_t stub_adc_dma_length;
+uint32_t stub_awd_high;
+
+uint8_t g4_connected = 1;
+uint8_t g4_upload_flag = 0;
+Weather_TypeDef g4_weather = { "Guilin", "Cloudy", "26", 1 };
+
+// 固定时刻：2025-10-17 14:30:05 星期五
+const RTC_TimeTypeDef stub_time = { 5, 30, 14, 17, 5, 10, 25 };
+
+HAL_StatusTypeDef ADC1_ConfigTrigger(uint32_t trigger, const uint32_t *channels, uint8_t count, uint32_t sampling_time)
+{
+    (void)trigger;
+    (void)channels;
+    (void)count;
+    (void)sampling_time;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADCEx_Calibration_Start(ADC_HandleTypeDef *hadc)
+{
+    (void)hadc;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_AnalogWDGConfig(ADC_HandleTypeDef *hadc, ADC_AnalogWDGConfTypeDef *AnalogWDGConfig)
+{
+    stub_awd_high = AnalogWDGConfig->HighThreshold;
+    if (AnalogWDGConfig->ITMode == ENABLE)
+    {
+        __HAL_ADC_ENABLE_IT(hadc, ADC_IT_AWD);
+    }
+    else
+    {
+        __HAL_ADC_DISABLE_IT(hadc, ADC_IT_AWD);
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef *hadc, uint32_t *pData, uint32_t Length)
+{
+    (void)hadc;
+    stub_adc_dma_buffer = (uint16_t *)pData;
+    stub_adc_dma_length = Length;
+    stub_adc_dma_channel.CNDTR = Length;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Start(TIM_HandleTypeDef *htim)
+{
+    (void)htim;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef PCF8563_GetTime(RTC_TimeTypeDef *time)
+{
+    *time = stub_time;
+    return HAL_OK;
+}
+
+uint32_t TIMER_GetTick(void)
+{
+    return stub_tick;
+}
+
+uint32_t G4_GetDroppedBytes(void)
+{
+    return 0;
+}
+
+uint8_t G4_GetTxDepth(void)
+{
+    return 0;
+}
+
+uint32_t G4_GetTxInFlight(void)
+{
+    return 0;
+}
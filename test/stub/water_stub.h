@@ -0,0 +1,24 @@
+#ifndef __WATER_STUB_H
+#define __WATER_STUB_H
+
+/*
+ * water.c在主机上运行所需的ADC、定时器、RTC和4G替身(test/stub/water_stub.c)。
+ * ADC的DMA缓冲区由测试直接写入，再调用HAL的半满/全满回调模拟DMA中断。
+ */
+#include "main.h"
+#include "adc.h"
+#include "tim.h"
+#include "rtc.h"
+
+// HAL_ADC_Start_DMA传入的循环缓冲区
+extern uint16_t *stub_adc_dma_buffer;
+extern uint32_t stub_adc_dma_length;
+// ADC的DMA通道寄存器，CNDTR为剩余计数(看门狗回调据此定位触发的样本)
+extern DMA_Channel_TypeDef stub_adc_dma_channel;
+// HAL_ADC_AnalogWDGConfig设置的看门狗上限，转换值大于它且中断开启时应调用看门狗回调
+extern uint32_t stub_awd_high;
+
+// 时间页显示的固定时刻
+extern const RTC_TimeTypeDef stub_time;
+
+#endif /* __WATER_STUB_H */
@@ -0,0 +1,170 @@
+#include "water_stub.h"
+#include "water.h"
+#include "calib.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * 水位报警：water.c按固件原样编译，逐次转换写入ADC的DMA缓冲区，
+ * 看门狗中断开启且转换值超过上限时调用看门狗回调，每次转换后运行一次主循环(WATER_Process)。
+ * 1. 水位稳定后采样率降到最低档，阶跃到阈值以上时看门狗报警立即恢复全速，
+ *    滤波后的水位在确认时间内确认，只报警一次，不被当作干扰
+ * 2. 水位回落到刚好低于阈值(之后不再有1%的变化)，
+ *    报警解除时屏幕上的水位页面必须与重新绘制的完全一致(不残留报警标志)。
+ */
+
+static uint32_t dma_pos;        // DMA下一个写入位置
+static uint32_t time_us;        // 不足1ms的时间
+
+// 通道0的报警状态变化
+static WaterAlarm_TypeDef last_state = WATER_ALARM_ARMED;
+static uint32_t raised;         // ARMED -> PENDING/ACTIVE
+static uint32_t false_alarms;   // PENDING -> ARMED(滤波未确认)
+static uint8_t raised_rate_level; // 最近一次报警时的采样率档位
+
+/**
+  * @brief  模拟一次定时触发的扫描转换，所有通道取同一个ADC值，之后运行一次主循环
+  * @param  adc: ADC码
+  * @retval None
+  */
+static void TEST_Convert(uint16_t adc)
+{
+    uint16_t rate = WATER_GetSampleRate();
+
+    for (uint8_t ch = 0; ch < WATER_CHANNELS; ch++)
+    {
+        stub_adc_dma_buffer[dma_pos++] = adc;
+    }
+    stub_adc_dma_channel.CNDTR = stub_adc_dma_length - dma_pos;
+    if (stub_adc_dma_channel.CNDTR == 0)
+    {
+        stub_adc_dma_channel.CNDTR = stub_adc_dma_length;
+    }
+
+    if ((stub_adc1.CR1 & ADC_CR1_AWDIE) && adc > stub_awd_high)
+    {
+        HAL_ADC_LevelOutOfWindowCallback(&hadc1);
+    }
+    if (dma_pos == stub_adc_dma_length / 2)
+    {
+        HAL_ADC_ConvHalfCpltCallback(&hadc1);
+    }
+    else if (dma_pos == stub_adc_dma_length)
+    {
+        dma_pos = 0;
+        HAL_ADC_ConvCpltCallback(&hadc1);
+    }
+
+    time_us += 1000000UL / rate;
+    stub_tick += time_us / 1000;
+    time_us %= 1000;
+
+    WATER_Process();
+
+    WaterAlarm_TypeDef state = WATER_GetAlarmState(0);
+    if (last_state == WATER_ALARM_ARMED && state != WATER_ALARM_ARMED)
+    {
+        raised++;
+        raised_rate_level = WATER_GetRateLevel();
+    }
+    else if (last_state == WATER_ALARM_PENDING && state == WATER_ALARM_ARMED)
+    {
+        false_alarms++;
+    }
+    last_state = state;
+}
+
+/**
+  * @brief  以固定水位运行一段时间
+  * @param  level: 水位(%)
+  * @param  ms: 最长时长
+  * @param  until: 通道0进入此报警状态时提前返回，-1表示运行到底
+  * @retval None
+  */
+static void TEST_Run(uint8_t level, uint32_t ms, int8_t until)
+{
+    uint16_t adc = CALIB_LevelToAdc(0, level);
+    uint32_t end = stub_tick + ms;
+
+    while ((int32_t)(end - stub_tick) > 0)
+    {
+        TEST_Convert(adc);
+        if ((int8_t)WATER_GetAlarmState(0) == until)
+        {
+            break;
+        }
+    }
+}
+
+/**
+  * @brief  刷新到屏幕并取得屏幕镜像的PBM文本
+  * @retval 文本(调用者释放)，镜像与缓存不一致时为NULL
+  */
+static char *TEST_Snapshot(void)
+{
+    char *text = NULL;
+    size_t size;
+
+    OLED_Refresh();
+    if (OLED_MirrorCheck() != 0)
+    {
+        return NULL;
+    }
+    stub_rtt = open_memstream(&text, &size);
+    OLED_MirrorDump("water");
+    fclose(stub_rtt);
+    stub_rtt = NULL;
+    return text;
+}
+
+int main(void)
+{
+    uint8_t threshold = FLASH_GetWaterThreshold(0);
+    int errors = 0;
+
+    CALIB_Init();
+    OLED_Init();
+    WATER_Init();
+
+    // 稳定在阈值以下，采样率逐档降到最低
+    TEST_Run(threshold - 30, 60000, -1);
+
+    if (WATER_GetRateLevel() != WATER_ADAPT_LEVELS - 1)
+    {
+        printf("alarm: rate level %u after a minute at a steady level\n", WATER_GetRateLevel());
+        errors++;
+    }
+
+    // 阶跃到阈值以上：看门狗立即报警并恢复全速采样，在确认时间内由滤波后的水位确认，只报警一次
+    TEST_Run(threshold + 10, 10000, WATER_ALARM_ACTIVE);
+    if (WATER_GetAlarmState(0) != WATER_ALARM_ACTIVE || raised != 1 || false_alarms != 0 || raised_rate_level != 0)
+    {
+        printf("alarm: state %u, raised %u times, %u unconfirmed, rate level %u at the alarm\n",
+               WATER_GetAlarmState(0), raised, false_alarms, raised_rate_level);
+        errors++;
+    }
+
+    // 回落到刚好低于阈值：水位变为阈值-1%时页面按报警状态重画，同一次主循环里报警随后解除，
+    // 之后水位不再变化；在解除的时刻与重新绘制的页面比较
+    TEST_Run(threshold - 1, 10000, WATER_ALARM_ARMED);
+    if (WATER_GetAlarmState(0) != WATER_ALARM_ARMED || WATER_GetCurrentLevel(0) != threshold - 1)
+    {
+        printf("alarm: state %u at %u%% after the level fell below %u%%\n",
+               WATER_GetAlarmState(0), WATER_GetCurrentLevel(0), threshold);
+        errors++;
+    }
+
+    char *shown = TEST_Snapshot();
+    WATER_DisplayWaterPage();
+    char *redrawn = TEST_Snapshot();
+    if (WATER_GetCurrentPage() != PAGE_WATER || !shown || !redrawn || strcmp(shown, redrawn) != 0)
+    {
+        printf("alarm: water page still shows the cleared alarm\n");
+        errors++;
+    }
+    free(shown);
+    free(redrawn);
+
+    printf("alarm: %d errors\n", errors);
+    return errors != 0;
+}
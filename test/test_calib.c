@@ -0,0 +1,138 @@
+#include "main.h"
+#include "calib.h"
+#include "flash.h"
+#include "perf.h"
+#include <math.h>
+
+/*
+ * 水位标定表：
+ * 1. 默认表在原分段判断的各档门限处结果相同，门限之间插值不超出原来的档位
+ * 2. 默认表和自定义表对全部4096个ADC值与浮点线性插值相差不超过1%，且单调不减
+ * 3. CALIB_LevelToAdc与逐个查表的结果一致
+ * 4. 无效的标定表被拒绝；有效的标定表写入参数页，重新初始化后仍然生效
+ * 最后运行CALIB_Benchmark(主机上PERF的单位为ns)
+ */
+
+static uint32_t errors;
+
+#define CHECK(cond, ...)                        \
+    do                                          \
+    {                                           \
+        if (!(cond) && errors++ < 10)           \
+        {                                       \
+            printf("calib: " __VA_ARGS__);      \
+        }                                       \
+    } while (0)
+
+/**
+  * @brief  原WATER_GetLevel的分段判断
+  */
+static uint8_t TEST_OldLevel(uint16_t adc)
+{
+    static const uint16_t thresholds[] = {270, 320, 380, 430, 500, 600, 830, 1150, 1800, 2450};
+    uint8_t level = 0;
+
+    for (uint8_t i = 0; i < sizeof(thresholds) / sizeof(thresholds[0]); i++)
+    {
+        if (adc >= thresholds[i])
+        {
+            level = (i + 1) * 10;
+        }
+    }
+    return level;
+}
+
+/**
+  * @brief  浮点线性插值，作为查表的参考
+  */
+static double TEST_Reference(const CALIB_Point_TypeDef *points, uint8_t count, uint16_t adc)
+{
+    if (adc <= points[0].adc)
+    {
+        return points[0].percent;
+    }
+    for (uint8_t i = 1; i < count; i++)
+    {
+        if (adc < points[i].adc)
+        {
+            return points[i - 1].percent + (double)(adc - points[i - 1].adc)
+                 * (points[i].percent - points[i - 1].percent) / (points[i].adc - points[i - 1].adc);
+        }
+    }
+    return points[count - 1].percent;
+}
+
+/**
+  * @brief  当前标定表对全部ADC值的插值精度、单调性和反查
+  */
+static void TEST_Table(const char *name)
+{
+    CALIB_Point_TypeDef points[CALIB_MAX_POINTS];
+    uint8_t count = CALIB_GetTable(0, points, CALIB_MAX_POINTS);
+    uint8_t last = 0;
+
+    for (uint16_t adc = 0; adc < 4096; adc++)
+    {
+        uint8_t level = CALIB_Lookup(0, adc);
+        double ref = TEST_Reference(points, count, adc);
+
+        CHECK(fabs(level - ref) <= 1.0, "%s: adc %u gives %u%%, expected %.2f%%\n", name, adc, level, ref);
+        CHECK(level >= last, "%s: adc %u gives %u%% after %u%%\n", name, adc, level, last);
+        last = level;
+    }
+
+    for (uint8_t percent = 0; percent <= 100; percent++)
+    {
+        uint16_t adc = 0;
+        while (adc < 4095 && CALIB_Lookup(0, adc) < percent)
+        {
+            adc++;
+        }
+        CHECK(CALIB_LevelToAdc(0, percent) == adc, "%s: %u%% maps back to adc %u, expected %u\n",
+              name, percent, CALIB_LevelToAdc(0, percent), adc);
+    }
+}
+
+int main(void)
+{
+    static const CALIB_Point_TypeDef custom[] = {{100, 0}, {900, 25}, {901, 26}, {3000, 80}, {4000, 100}};
+    static const CALIB_Point_TypeDef decreasing[] = {{100, 0}, {900, 50}, {800, 100}};
+    static const CALIB_Point_TypeDef falling[] = {{100, 0}, {900, 60}, {1000, 50}};
+    static const CALIB_Point_TypeDef too_high[] = {{100, 0}, {4096, 100}};
+    CALIB_Point_TypeDef points[CALIB_MAX_POINTS];
+
+    PERF_Init();
+
+    // 参数页为空，使用默认表
+    CALIB_Init();
+    for (uint16_t adc = 0; adc < 4096; adc++)
+    {
+        uint8_t old = TEST_OldLevel(adc);
+        uint8_t level = CALIB_Lookup(0, adc);
+
+        CHECK(level >= old && level <= old + 10, "default: adc %u gives %u%%, old level %u%%\n", adc, level, old);
+        CHECK(adc == 0 || TEST_OldLevel(adc - 1) == old || level == old,
+              "default: threshold %u gives %u%%, old level %u%%\n", adc, level, old);
+    }
+    TEST_Table("default");
+
+    // 无效的表不保存，当前表不变
+    CHECK(CALIB_SetTable(0, decreasing, 3) == HAL_ERROR, "decreasing adc accepted\n");
+    CHECK(CALIB_SetTable(0, falling, 3) == HAL_ERROR, "falling percent accepted\n");
+    CHECK(CALIB_SetTable(0, too_high, 2) == HAL_ERROR, "adc above 4095 accepted\n");
+    CHECK(CALIB_SetTable(0, custom, 1) == HAL_ERROR, "single point accepted\n");
+    CHECK(CALIB_SetTable(WATER_CHANNELS, custom, 5) == HAL_ERROR, "bad channel accepted\n");
+    CHECK(CALIB_GetTable(0, points, CALIB_MAX_POINTS) == 11, "invalid table replaced the default\n");
+
+    // 自定义表保存到参数页，重新初始化后仍然生效
+    CHECK(CALIB_SetTable(0, custom, 5) == HAL_OK, "custom table rejected\n");
+    CALIB_Init();
+    CHECK(CALIB_GetTable(0, points, CALIB_MAX_POINTS) == 5 && points[2].adc == 901 && points[4].percent == 100,
+          "custom table not restored from flash\n");
+    TEST_Table("custom");
+
+    CALIB_Benchmark();
+
+    printf("calib: %u errors\n", errors);
+    return errors != 0;
+}
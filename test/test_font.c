@@ -0,0 +1,71 @@
+#include "main.h"
+#include "font.h"
+#include "oledfont_pack.h"
+#include "oledfont.h"
+#include <string.h>
+
+/*
+ * 压缩字库往返：Font8x16的每个字模解码后必须与oledfont.h中的原始F8X16逐字节一致，
+ * 比例宽度表覆盖字模的全部非零列，字库外的字符解码和测宽都返回0。
+ */
+
+#define GLYPH_BYTES     16
+
+int main(void)
+{
+    uint8_t out[GLYPH_BYTES];
+    const uint8_t *raw;
+    uint8_t left;
+    uint8_t width;
+    int errors = 0;
+
+    for (int c = ' '; c <= '~'; c++)
+    {
+        raw = &F8X16[(c - ' ') * GLYPH_BYTES];
+
+        memset(out, 0xAA, sizeof(out));
+        if (FONT_Decode(&Font8x16, c, out) != GLYPH_BYTES || memcmp(out, raw, GLYPH_BYTES) != 0)
+        {
+            printf("font: '%c' decodes differently from F8X16\n", c);
+            errors++;
+            continue;
+        }
+
+        // 宽度表之外的列必须全为空白
+        width = FONT_GlyphWidth(&Font8x16, c, &left);
+        if (width == 0 || left + width > Font8x16.width)
+        {
+            printf("font: '%c' bad metrics %u+%u\n", c, left, width);
+            errors++;
+            continue;
+        }
+        for (uint8_t col = 0; col < Font8x16.width; col++)
+        {
+            if ((col < left || col >= left + width) && (raw[col] | raw[col + Font8x16.width]) != 0)
+            {
+                printf("font: '%c' column %u outside metrics %u+%u\n", c, col, left, width);
+                errors++;
+                break;
+            }
+        }
+    }
+
+    // 字库范围之外
+    const uint8_t outside[] = {0x00, 0x1F, 0x7F, 0xFF};
+    for (uint8_t i = 0; i < sizeof(outside); i++)
+    {
+        if (FONT_Decode(&Font8x16, outside[i], out) != 0 || FONT_GlyphWidth(&Font8x16, outside[i], NULL) != 0)
+        {
+            printf("font: code 0x%02X outside the font was accepted\n", outside[i]);
+            errors++;
+        }
+    }
+    if (FONT_MeasureText(&Font8x16, "\x7F\x1F") != 0)
+    {
+        printf("font: text of unknown codes has non-zero width\n");
+        errors++;
+    }
+
+    printf("font: %d glyphs checked, %d errors\n", '~' - ' ' + 1, errors);
+    return errors != 0;
+}
@@ -0,0 +1,131 @@
+#include "main.h"
+#include "framer.h"
+#include <string.h>
+
+/*
+ * 模块数据流分帧：
+ * 1. 每段测试数据整体喂入后超时检查一次，事件序列写入文件与golden/framer_events.txt比较
+ * 2. 在任意两处切开分三段喂入(按G4_ProcessData的方式，复位后从返回的位置继续喂)，
+ *    事件序列必须与整体喂入完全一致
+ */
+
+static const char *const streams[] = {
+    // 响应行、含括号和转义的透传JSON、URC及其定长负载、处理函数中复位、无行尾的提示符
+    "\r\nOK\r\n{\"a\":\"}{\\\"\",\"b\":[1,{}]}\r\n+RECV:5\r\nhe\nlo\r\nAT+X\r\nRESET\r\n"
+    "ERROR\r\n[1,2]\r\n> ",
+    // JSON未结束即超时
+    "OK\r\n{\"a\":[1,",
+    // 定长负载未收完即超时
+    "+RECV:5\r\nhel",
+};
+
+#define STREAM_COUNT    (sizeof(streams) / sizeof(streams[0]))
+
+static char events[1024];
+static uint16_t events_len;
+
+static void TEST_Print(const char *fmt, const char *text, uint16_t len)
+{
+    events_len += snprintf(events + events_len, sizeof(events) - events_len, fmt, len, text);
+}
+
+static void TEST_Line(FRAMER_TypeDef *f, const char *line, uint16_t len)
+{
+    TEST_Print("line %u [%s]\n", line, len);
+    // 模拟G4_ClearBuffer：处理函数中复位
+    if (strcmp(line, "RESET") == 0)
+    {
+        FRAMER_Reset(f);
+    }
+}
+
+static void TEST_Urc(FRAMER_TypeDef *f, const char *line, uint16_t len)
+{
+    TEST_Print("urc %u [%s]\n", line, len);
+    FRAMER_ExpectPayload(f, 5);
+}
+
+static void TEST_Data(FRAMER_TypeDef *f, const uint8_t *data, uint16_t len, FRAMER_End end)
+{
+    static const char *const ends[] = {"", " done", " abort"};
+
+    // 片段的切分位置随喂入方式变化，只有内容和结束标记参与比较
+    if (len)
+    {
+        events_len += snprintf(events + events_len, sizeof(events) - events_len, "%.*s", len, data);
+    }
+    if (end != FRAMER_MORE)
+    {
+        events_len += snprintf(events + events_len, sizeof(events) - events_len, "%s\n", ends[end]);
+    }
+}
+
+/**
+  * @brief  喂入一段数据，复位后从返回的位置继续
+  */
+static void TEST_Feed(FRAMER_TypeDef *f, const char *data, size_t len)
+{
+    while (len)
+    {
+        uint16_t n = FRAMER_Feed(f, (const uint8_t *)data, len, 0);
+        data += n;
+        len -= n;
+    }
+}
+
+/**
+  * @brief  分三段喂入一段数据，再检查超时
+  * @retval 事件文本
+  */
+static const char *TEST_Parse(const char *stream, size_t a, size_t b)
+{
+    FRAMER_TypeDef f;
+    size_t n = strlen(stream);
+
+    FRAMER_Init(&f, TEST_Line, TEST_Data, NULL);
+    FRAMER_Register(&f, "+RECV:", TEST_Urc);
+    events_len = 0;
+    events[0] = '\0';
+    TEST_Feed(&f, stream, a);
+    TEST_Feed(&f, stream + a, b - a);
+    TEST_Feed(&f, stream + b, n - b);
+    FRAMER_Poll(&f, FRAMER_TIMEOUT_MS);
+    return events;
+}
+
+int main(int argc, char *argv[])
+{
+    static char whole[sizeof(events)];
+    uint32_t splits = 0, mismatches = 0;
+    FILE *out;
+
+    if (argc < 2 || (out = fopen(argv[1], "w")) == NULL)
+    {
+        printf("usage: %s events.txt\n", argv[0]);
+        return 2;
+    }
+
+    for (uint8_t s = 0; s < STREAM_COUNT; s++)
+    {
+        size_t n = strlen(streams[s]);
+
+        strcpy(whole, TEST_Parse(streams[s], n, n));
+        fprintf(out, "# %u\n%s", s, whole);
+
+        for (size_t a = 0; a <= n; a++)
+        {
+            for (size_t b = a; b <= n; b++)
+            {
+                splits++;
+                if (strcmp(TEST_Parse(streams[s], a, b), whole) != 0 && mismatches++ < 5)
+                {
+                    printf("framer: stream %u split at %zu,%zu differs\n", s, a, b);
+                }
+            }
+        }
+    }
+    fclose(out);
+
+    printf("framer: %u splits, %u mismatches\n", splits, mismatches);
+    return mismatches != 0;
+}
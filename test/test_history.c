@@ -0,0 +1,98 @@
+#include "main.h"
+#include "oled.h"
+#include "scene.h"
+#include "history.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * 历史曲线滚动绘制：模拟4小时的水位(含一段短间隔和一段超过整个窗口的间隔)，
+ * 每结束一个桶按SCENE_SetHistory的增量路径(左移+补画)更新屏幕，
+ * 再强制整体重绘，两次经屏幕镜像得到的画面必须完全一致。
+ */
+
+#define BUCKET_MS   30000UL
+
+static SCENE_Widget_TypeDef graph;
+static HISTORY_TypeDef history;
+
+/**
+  * @brief  刷新到屏幕并取得屏幕镜像的PBM文本
+  * @retval 文本(调用者释放)，镜像与缓存不一致时为NULL
+  */
+static char *TEST_Snapshot(void)
+{
+    char *text = NULL;
+    size_t size;
+    
+    OLED_Refresh();
+    if (OLED_MirrorCheck() != 0)
+    {
+        return NULL;
+    }
+    stub_rtt = open_memstream(&text, &size);
+    OLED_MirrorDump("history");
+    fclose(stub_rtt);
+    stub_rtt = NULL;
+    return text;
+}
+
+/**
+  * @brief  模拟水位：缓慢涨落叠加锯齿
+  * @param  t: 时刻(s)
+  * @retval 水位(%)
+  */
+static uint8_t TEST_Level(uint32_t t)
+{
+    uint32_t phase = t % 2400;
+    uint32_t level = (phase < 1200) ? 20 + phase * 60 / 1200 : 80 - (phase - 1200) * 60 / 1200;
+    return level + (t / 7) % 5;
+}
+
+int main(void)
+{
+    uint32_t buckets = 0, scrolls = 0, mismatches = 0;
+    
+    OLED_Init();
+    SCENE_InitGraph(&graph, (OLED_WIDTH - HISTORY_SIZE) / 2, 2, HISTORY_SIZE, 6);
+    HISTORY_Init(&history, BUCKET_MS, 0);
+    
+    for (uint32_t t = 1; t <= 4 * 3600; t++)
+    {
+        // 1:00~1:20无样本(40个桶一次补齐)，2:00~3:10无样本(超过整个窗口)
+        if ((t > 3600 && t < 4800) || (t > 7200 && t < 11400))
+        {
+            continue;
+        }
+        if (HISTORY_Add(&history, t * 1000, TEST_Level(t)) == 0)
+        {
+            continue;
+        }
+        
+        uint32_t added = history.total - graph.u.graph.total;
+        SCENE_SetHistory(&graph, &history);
+        char *scrolled = TEST_Snapshot();
+        
+        graph.valid = 0;
+        SCENE_SetHistory(&graph, &history);
+        char *full = TEST_Snapshot();
+        
+        if (!scrolled || !full || strcmp(scrolled, full) != 0)
+        {
+            if (mismatches++ < 5)
+            {
+                printf("mismatch at t=%us, %u new buckets\n", t, added);
+            }
+        }
+        if (added < HISTORY_SIZE)
+        {
+            scrolls++;
+        }
+        buckets++;
+        free(scrolled);
+        free(full);
+    }
+    
+    printf("history: %u redraws (%u scrolled), %u mismatches\n", buckets, scrolls, mismatches);
+    return mismatches != 0;
+}
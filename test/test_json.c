@@ -0,0 +1,118 @@
+#include "main.h"
+#include "json.h"
+#include <string.h>
+
+/*
+ * 流式JSON解析：
+ * 1. 每个测试文档整体喂入，事件序列写入文件与golden/json_events.txt比较(含全部转义和语法错误)
+ * 2. 在任意两处切开分三段喂入，事件序列必须与整体喂入完全一致
+ * 3. 在转义中途JSON_Reset，之后的文档解析结果与新建的解析器相同
+ */
+
+static const char *const docs[] = {
+    // 天气应答，前面带模块输出的无关字节
+    "junk+QMT: {\"results\":[{\"location\":{\"id\":\"WK\",\"name\":\"Guilin\"},"
+    "\"now\":{\"text\":\"Cloudy\",\"code\":\"4\",\"temperature\":\"26\"}}]}",
+    // 物模型属性设置，含嵌套数组、字面量和数字
+    "{\"method\":\"thing.service.property.set\",\"id\":\"1\",\"params\":{\"water_threshold\":50,"
+    "\"water_calib_2\":[[100, 0],[ 2000,50 ],[4000,100]],\"b\":true,\"f\":false,\"n\":null},\"version\":\"1.0\"}",
+    // RFC 8259的全部转义，键名中也有转义
+    "{\"s\":\"q\\\"b\\\\s\\/b\\bf\\fn\\nr\\rt\\tu\\u00e9\\u20AC.\",\"k\\ty\":1}",
+    // 非法转义：丢弃该文档，随后的文档正常解析
+    "{\"a\":\"x\\qy\"}{\"b\":2}",
+    // \u后不是十六进制位
+    "{\"a\":\"\\u12G4\"}{\"c\":3}",
+    // 括号不匹配
+    "{\"a\":[1,2}",
+};
+
+#define DOC_COUNT   (sizeof(docs) / sizeof(docs[0]))
+
+static char events[4096];
+static uint16_t events_len;
+
+static void TEST_Event(JSON_ParserTypeDef *p, JSON_Type type, const char *value, uint8_t len)
+{
+    events_len += snprintf(events + events_len, sizeof(events) - events_len, "%d %s[%u,%u]=",
+                           type, p->path, JSON_Index(p, 0), JSON_Index(p, 1));
+    // 控制字符以\xNN输出，基准文件保持可读
+    for (uint8_t i = 0; i < len; i++)
+    {
+        const char *fmt = ((uint8_t)value[i] < 0x20) ? "\\x%02X" : "%c";
+        events_len += snprintf(events + events_len, sizeof(events) - events_len, fmt, (uint8_t)value[i]);
+    }
+    events_len += snprintf(events + events_len, sizeof(events) - events_len, "\n");
+}
+
+/**
+  * @brief  分三段喂入一个文档
+  * @retval 事件文本
+  */
+static const char *TEST_Parse(const char *doc, size_t a, size_t b)
+{
+    JSON_ParserTypeDef p;
+    size_t n = strlen(doc);
+
+    JSON_Init(&p, TEST_Event, NULL);
+    events_len = 0;
+    events[0] = '\0';
+    JSON_Feed(&p, doc, a);
+    JSON_Feed(&p, doc + a, b - a);
+    JSON_Feed(&p, doc + b, n - b);
+    return events;
+}
+
+int main(int argc, char *argv[])
+{
+    static char whole[DOC_COUNT][sizeof(events)];
+    uint32_t splits = 0, mismatches = 0;
+    FILE *out;
+
+    if (argc < 2 || (out = fopen(argv[1], "w")) == NULL)
+    {
+        printf("usage: %s events.txt\n", argv[0]);
+        return 2;
+    }
+
+    for (uint8_t d = 0; d < DOC_COUNT; d++)
+    {
+        size_t n = strlen(docs[d]);
+
+        strcpy(whole[d], TEST_Parse(docs[d], n, n));
+        fprintf(out, "# %u\n%s", d, whole[d]);
+
+        for (size_t a = 0; a <= n; a++)
+        {
+            for (size_t b = a; b <= n; b++)
+            {
+                splits++;
+                if (strcmp(TEST_Parse(docs[d], a, b), whole[d]) != 0 && mismatches++ < 5)
+                {
+                    printf("json: doc %u split at %zu,%zu differs\n", d, a, b);
+                }
+            }
+        }
+    }
+    fclose(out);
+
+    // 在转义的每个位置中途复位，之后喂入的文档不受影响
+    const char *escapes = docs[2];
+    for (size_t cut = 0; cut <= strlen(escapes); cut++)
+    {
+        JSON_ParserTypeDef p;
+
+        JSON_Init(&p, TEST_Event, NULL);
+        JSON_Feed(&p, escapes, cut);
+        JSON_Reset(&p);
+        events_len = 0;
+        events[0] = '\0';
+        JSON_Feed(&p, docs[1], strlen(docs[1]));
+        if (strcmp(events, whole[1]) != 0 && mismatches++ < 5)
+        {
+            printf("json: reset after %zu bytes leaks into the next document\n", cut);
+        }
+    }
+
+    printf("json: %u splits, %u mismatches\n", splits, mismatches);
+    return mismatches != 0;
+}
@@ -0,0 +1,79 @@
+#include "main.h"
+#include "median.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * 中位数引擎：快速选择和两级直方图对各种长度、数据分布和序号k的结果必须与排序后的第k个元素一致，
+ * 之后在主机上运行MEDIAN_Benchmark(主机上PERF的单位为ns)
+ */
+
+#define MAX_LEN     1024
+
+static uint16_t src[MAX_LEN];
+static uint16_t sorted[MAX_LEN];
+static uint16_t work[MAX_LEN];
+
+static int TEST_Compare(const void *a, const void *b)
+{
+    return *(const uint16_t *)a - *(const uint16_t *)b;
+}
+
+/**
+  * @brief  按分布生成len个12位样本
+  * @param  shape: 0随机 1全相同 2升序 3降序 4只有两个值 5集中在一个粗格内
+  */
+static void TEST_Fill(uint16_t len, uint8_t shape, uint32_t *seed)
+{
+    for (uint16_t i = 0; i < len; i++)
+    {
+        *seed = *seed * 1103515245 + 12345;
+        uint16_t r = (*seed >> 16) & 0x0FFF;
+        switch (shape)
+        {
+        case 0:  src[i] = r;                                  break;
+        case 1:  src[i] = 2048;                               break;
+        case 2:  src[i] = i * 4095 / MAX_LEN;                 break;
+        case 3:  src[i] = 4095 - i * 4095 / MAX_LEN;          break;
+        case 4:  src[i] = (r & 1) ? 4095 : 0;                 break;
+        default: src[i] = 1984 + (r & 0x3F);                  break;
+        }
+    }
+}
+
+int main(void)
+{
+    static const uint16_t lens[] = {1, 2, 3, 5, 64, 100, 255, 256, 1000, 1024};
+    uint32_t seed = 1;
+    uint32_t checks = 0, errors = 0;
+
+    for (uint8_t l = 0; l < sizeof(lens) / sizeof(lens[0]); l++)
+    {
+        uint16_t len = lens[l];
+
+        for (uint8_t shape = 0; shape < 6; shape++)
+        {
+            TEST_Fill(len, shape, &seed);
+            memcpy(sorted, src, len * sizeof(src[0]));
+            qsort(sorted, len, sizeof(sorted[0]), TEST_Compare);
+
+            for (uint16_t k = 0; k < len; k++)
+            {
+                memcpy(work, src, len * sizeof(src[0]));
+                uint16_t q = MEDIAN_QuickSelect(work, len, k);
+                uint16_t h = MEDIAN_Histogram(src, len, k);
+                checks++;
+                if ((q != sorted[k] || h != sorted[k]) && errors++ < 5)
+                {
+                    printf("median: len=%u shape=%u k=%u: quickselect %u, histogram %u, expected %u\n",
+                           len, shape, k, q, h, sorted[k]);
+                }
+            }
+        }
+    }
+
+    MEDIAN_Benchmark();
+
+    printf("median: %u checks, %u errors\n", checks, errors);
+    return errors != 0;
+}